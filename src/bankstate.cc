@@ -6,14 +6,17 @@ BankState::BankState()
     : state_(State::CLOSED),
       cmd_timing_(static_cast<int>(CommandType::SIZE)),
       open_row_(-1),
-      row_hit_count_(0) {
+      row_hit_count_(0),
+      raa_count_(0) {
     cmd_timing_[static_cast<int>(CommandType::READ)] = 0;
     cmd_timing_[static_cast<int>(CommandType::READ_PRECHARGE)] = 0;
     cmd_timing_[static_cast<int>(CommandType::WRITE)] = 0;
     cmd_timing_[static_cast<int>(CommandType::WRITE_PRECHARGE)] = 0;
     cmd_timing_[static_cast<int>(CommandType::ACTIVATE)] = 0;
     cmd_timing_[static_cast<int>(CommandType::PRECHARGE)] = 0;
+    cmd_timing_[static_cast<int>(CommandType::ROW_REFRESH)] = 0;
     cmd_timing_[static_cast<int>(CommandType::REFRESH)] = 0;
+    cmd_timing_[static_cast<int>(CommandType::RFM)] = 0;
     cmd_timing_[static_cast<int>(CommandType::SREF_ENTER)] = 0;
     cmd_timing_[static_cast<int>(CommandType::SREF_EXIT)] = 0;
 }
@@ -30,8 +33,10 @@ Command BankState::GetReadyCommand(const Command& cmd, uint64_t clk) const {
                 case CommandType::WRITE_PRECHARGE:
                     required_type = CommandType::ACTIVATE;
                     break;
+                case CommandType::ROW_REFRESH:
                 case CommandType::REFRESH:
                 case CommandType::REFRESH_BANK:
+                case CommandType::RFM:
                 case CommandType::SREF_ENTER:
                     required_type = cmd.cmd_type;
                     break;
@@ -53,8 +58,10 @@ Command BankState::GetReadyCommand(const Command& cmd, uint64_t clk) const {
                         required_type = CommandType::PRECHARGE;
                     }
                     break;
+                case CommandType::ROW_REFRESH:
                 case CommandType::REFRESH:
                 case CommandType::REFRESH_BANK:
+                case CommandType::RFM:
                 case CommandType::SREF_ENTER:
                     required_type = CommandType::PRECHARGE;
                     break;
@@ -70,6 +77,8 @@ Command BankState::GetReadyCommand(const Command& cmd, uint64_t clk) const {
                 case CommandType::READ_PRECHARGE:
                 case CommandType::WRITE:
                 case CommandType::WRITE_PRECHARGE:
+                case CommandType::ROW_REFRESH:
+                case CommandType::RFM:
                     required_type = CommandType::SREF_EXIT;
                     break;
                 default:
@@ -109,8 +118,10 @@ void BankState::UpdateState(const Command& cmd) {
                     row_hit_count_ = 0;
                     break;
                 case CommandType::ACTIVATE:
+                case CommandType::ROW_REFRESH:
                 case CommandType::REFRESH:
                 case CommandType::REFRESH_BANK:
+                case CommandType::RFM:
                 case CommandType::SREF_ENTER:
                 case CommandType::SREF_EXIT:
                 default:
@@ -121,10 +132,15 @@ void BankState::UpdateState(const Command& cmd) {
             switch (cmd.cmd_type) {
                 case CommandType::REFRESH:
                 case CommandType::REFRESH_BANK:
+                case CommandType::RFM:
+                // closed again by its PRE; victim refreshes are not counted
+                // in RAA, TRR ones are internal to the DRAM
+                case CommandType::ROW_REFRESH:
                     break;
                 case CommandType::ACTIVATE:
                     state_ = State::OPEN;
                     open_row_ = cmd.Row();
+                    raa_count_++;
                     break;
                 case CommandType::SREF_ENTER:
                     state_ = State::SREF;
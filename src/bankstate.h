@@ -1,6 +1,7 @@
 #ifndef __BANKSTATE_H
 #define __BANKSTATE_H
 
+#include <algorithm>
 #include <vector>
 #include "common.h"
 
@@ -22,6 +23,9 @@ class BankState {
     bool IsRowOpen() const { return state_ == State::OPEN; }
     int OpenRow() const { return open_row_; }
     int RowHitCount() const { return row_hit_count_; }
+    // rolling accumulated ACTs (DDR5 RAA), REF and RFM decrease it
+    int RAACount() const { return raa_count_; }
+    void DecreaseRAA(int num) { raa_count_ = std::max(0, raa_count_ - num); }
 
    private:
     // Current state of the Bank
@@ -36,6 +40,8 @@ class BankState {
 
     // consecutive accesses to one row
     int row_hit_count_;
+
+    int raa_count_;
 };
 
 }  // namespace dramsim3
@@ -48,7 +48,8 @@ void ChannelState::BankNeedRefresh(int rank, int bankgroup, int bank,
         refresh_q_.emplace_back(CommandType::REFRESH_BANK, addr, -1);
     } else {
         for (auto it = refresh_q_.begin(); it != refresh_q_.end(); it++) {
-            if (it->Rank() == rank && it->Bankgroup() == bankgroup &&
+            if (it->cmd_type == CommandType::REFRESH_BANK &&
+                it->Rank() == rank && it->Bankgroup() == bankgroup &&
                 it->Bank() == bank) {
                 refresh_q_.erase(it);
                 break;
@@ -58,13 +59,60 @@ void ChannelState::BankNeedRefresh(int rank, int bankgroup, int bank,
     return;
 }
 
+void ChannelState::BankNeedRFM(int rank, int bankgroup, int bank, bool need) {
+    for (auto it = rfm_postponed_.begin(); it != rfm_postponed_.end(); it++) {
+        if (it->rank == rank && it->bankgroup == bankgroup &&
+            it->bank == bank) {
+            rfm_postponed_.erase(it);
+            break;
+        }
+    }
+    for (auto it = refresh_q_.begin(); it != refresh_q_.end(); it++) {
+        if (it->cmd_type == CommandType::RFM && it->Rank() == rank &&
+            it->Bankgroup() == bankgroup && it->Bank() == bank) {
+            if (!need) {
+                refresh_q_.erase(it);
+            }
+            return;
+        }
+    }
+    if (need) {
+        Address addr = Address(-1, rank, bankgroup, bank, -1, -1);
+        refresh_q_.emplace_back(CommandType::RFM, addr, -1);
+    }
+    return;
+}
+
+void ChannelState::UpdateRAA(int rank, int bankgroup, int bank) {
+    int raa = bank_states_[rank][bankgroup][bank].RAACount();
+    if (raa >= config_.raammt || (raa >= config_.raaimt && !config_.rfm_postpone)) {
+        BankNeedRFM(rank, bankgroup, bank, true);
+        return;
+    }
+    bool postponed = false;
+    for (auto it = rfm_postponed_.begin(); it != rfm_postponed_.end(); it++) {
+        if (it->rank == rank && it->bankgroup == bankgroup &&
+            it->bank == bank) {
+            if (raa < config_.raaimt) {
+                rfm_postponed_.erase(it);
+            }
+            postponed = true;
+            break;
+        }
+    }
+    if (!postponed && raa >= config_.raaimt) {
+        rfm_postponed_.push_back(Address(-1, rank, bankgroup, bank, -1, -1));
+    }
+    return;
+}
+
 void ChannelState::RankNeedRefresh(int rank, bool need) {
     if (need) {
         Address addr = Address(-1, rank, -1, -1, -1, -1);
         refresh_q_.emplace_back(CommandType::REFRESH, addr, -1);
     } else {
         for (auto it = refresh_q_.begin(); it != refresh_q_.end(); it++) {
-            if (it->Rank() == rank) {
+            if (it->cmd_type == CommandType::REFRESH && it->Rank() == rank) {
                 refresh_q_.erase(it);
                 break;
             }
@@ -105,7 +153,8 @@ Command ChannelState::GetReadyCommand(const Command& cmd, uint64_t clk) const {
         if (!ready_cmd.IsValid()) {
             return Command();
         }
-        if (ready_cmd.cmd_type == CommandType::ACTIVATE) {
+        if (ready_cmd.cmd_type == CommandType::ACTIVATE ||
+            ready_cmd.cmd_type == CommandType::ROW_REFRESH) {
             if (!ActivationWindowOk(ready_cmd.Rank(), clk)) {
                 return Command();
             }
@@ -119,6 +168,10 @@ void ChannelState::UpdateState(const Command& cmd) {
         for (auto j = 0; j < config_.bankgroups; j++) {
             for (auto k = 0; k < config_.banks_per_group; k++) {
                 bank_states_[cmd.Rank()][j][k].UpdateState(cmd);
+                if (config_.rfm && cmd.IsRefresh()) {
+                    bank_states_[cmd.Rank()][j][k].DecreaseRAA(config_.raaimt);
+                    UpdateRAA(cmd.Rank(), j, k);
+                }
             }
         }
         if (cmd.IsRefresh()) {
@@ -129,9 +182,21 @@ void ChannelState::UpdateState(const Command& cmd) {
             rank_is_sref_[cmd.Rank()] = false;
         }
     } else {
-        bank_states_[cmd.Rank()][cmd.Bankgroup()][cmd.Bank()].UpdateState(cmd);
+        auto& bank_state = bank_states_[cmd.Rank()][cmd.Bankgroup()][cmd.Bank()];
+        bank_state.UpdateState(cmd);
         if (cmd.IsRefresh()) {
             BankNeedRefresh(cmd.Rank(), cmd.Bankgroup(), cmd.Bank(), false);
+        } else if (cmd.cmd_type == CommandType::RFM) {
+            BankNeedRFM(cmd.Rank(), cmd.Bankgroup(), cmd.Bank(), false);
+        }
+        if (config_.rfm) {
+            if (cmd.IsRefresh() || cmd.cmd_type == CommandType::RFM) {
+                bank_state.DecreaseRAA(config_.raaimt);
+            }
+            if (cmd.IsRefresh() || cmd.cmd_type == CommandType::RFM ||
+                cmd.cmd_type == CommandType::ACTIVATE) {
+                UpdateRAA(cmd.Rank(), cmd.Bankgroup(), cmd.Bank());
+            }
         }
     }
     return;
@@ -140,6 +205,7 @@ void ChannelState::UpdateState(const Command& cmd) {
 void ChannelState::UpdateTiming(const Command& cmd, uint64_t clk) {
     switch (cmd.cmd_type) {
         case CommandType::ACTIVATE:
+        case CommandType::ROW_REFRESH:
             UpdateActivationTimes(cmd.Rank(), clk);
         case CommandType::READ:
         case CommandType::READ_PRECHARGE:
@@ -147,6 +213,7 @@ void ChannelState::UpdateTiming(const Command& cmd, uint64_t clk) {
         case CommandType::WRITE_PRECHARGE:
         case CommandType::PRECHARGE:
         case CommandType::REFRESH_BANK:
+        case CommandType::RFM:
             // TODO - simulator speed? - Speciazlize which of the below
             // functions to call depending on the command type  Same Bank
             UpdateSameBankTiming(
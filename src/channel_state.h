@@ -28,6 +28,11 @@ class ChannelState {
     const Command& PendingRefCommand() const {return refresh_q_.front(); }
     void BankNeedRefresh(int rank, int bankgroup, int bank, bool need);
     void RankNeedRefresh(int rank, bool need);
+    void BankNeedRFM(int rank, int bankgroup, int bank, bool need);
+    // banks past RAAIMT whose RFM the controller holds back (below RAAMMT)
+    const std::vector<Address>& PostponedRFMs() const {
+        return rfm_postponed_;
+    }
     int OpenRow(int rank, int bankgroup, int bank) const {
         return bank_states_[rank][bankgroup][bank].OpenRow();
     }
@@ -44,11 +49,13 @@ class ChannelState {
     std::vector<bool> rank_is_sref_;
     std::vector<std::vector<std::vector<BankState> > > bank_states_;
     std::vector<Command> refresh_q_;
+    std::vector<Address> rfm_postponed_;
 
     std::vector<std::vector<uint64_t> > four_aw_;
     std::vector<std::vector<uint64_t> > thirty_two_aw_;
     bool IsFAWReady(int rank, uint64_t curr_time) const;
     bool Is32AWReady(int rank, uint64_t curr_time) const;
+    void UpdateRAA(int rank, int bankgroup, int bank);
     // Update timing of the bank the command corresponds to
     void UpdateSameBankTiming(
         const Address& addr,
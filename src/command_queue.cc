@@ -1,4 +1,6 @@
 #include "command_queue.h"
+#include <algorithm>
+#include "rowhammer.h"
 
 namespace dramsim3 {
 
@@ -10,6 +12,7 @@ CommandQueue::CommandQueue(int channel_id, const Config& config,
       channel_state_(channel_state),
       simple_stats_(simple_stats),
       is_in_ref_(false),
+      throttle_(nullptr),
       queue_size_(static_cast<size_t>(config_.cmd_queue_size)),
       queue_idx_(0),
       clk_(0) {
@@ -31,9 +34,14 @@ CommandQueue::CommandQueue(int channel_id, const Config& config,
         cmd_queue.reserve(config_.cmd_queue_size);
         queues_.push_back(cmd_queue);
     }
+    row_refresh_queue_.reserve(config_.cmd_queue_size);
 }
 
 Command CommandQueue::GetCommandToIssue() {
+    auto row_refresh = GetReadyRowRefresh();
+    if (row_refresh.IsValid()) {
+        return row_refresh;
+    }
     for (int i = 0; i < num_queues_; i++) {
         auto& queue = GetNextQueue();
         // if we're refresing, skip the command queues that are involved
@@ -53,6 +61,30 @@ Command CommandQueue::GetCommandToIssue() {
     return Command();
 }
 
+Command CommandQueue::GetReadyRowRefresh() {
+    for (auto cmd_it = row_refresh_queue_.begin();
+         cmd_it != row_refresh_queue_.end(); cmd_it++) {
+        if (is_in_ref_ &&
+            ref_q_indices_.count(GetQueueIndex(
+                cmd_it->Rank(), cmd_it->Bankgroup(), cmd_it->Bank()))) {
+            continue;
+        }
+        // either the row refresh or the PRE closing the bank for it,
+        // taking precedence over row hits of the regular requests
+        auto cmd = channel_state_.GetReadyCommand(*cmd_it, clk_);
+        if (!cmd.IsValid()) {
+            continue;
+        }
+        if (cmd.cmd_type == CommandType::ROW_REFRESH) {
+            row_refresh_queue_.erase(cmd_it);
+        } else if (cmd.cmd_type == CommandType::PRECHARGE) {
+            simple_stats_.Increment("num_ondemand_pres");
+        }
+        return cmd;
+    }
+    return Command();
+}
+
 Command CommandQueue::FinishRefresh() {
     // we can do something fancy here like clearing the R/Ws
     // that already had ACT on the way but by doing that we
@@ -67,7 +99,7 @@ Command CommandQueue::FinishRefresh() {
     // either precharge or refresh
     auto cmd = channel_state_.GetReadyCommand(ref, clk_);
 
-    if (cmd.IsRefresh()) {
+    if (cmd.IsRefresh() || cmd.cmd_type == CommandType::RFM) {
         ref_q_indices_.clear();
         is_in_ref_ = false;
     }
@@ -109,9 +141,25 @@ bool CommandQueue::ArbitratePrecharge(const CMDIterator& cmd_it,
     return false;
 }
 
-bool CommandQueue::WillAcceptCommand(int rank, int bankgroup, int bank) const {
+bool CommandQueue::WillAcceptCommand(int rank, int bankgroup, int bank,
+                                     int num_cmds) const {
     int q_idx = GetQueueIndex(rank, bankgroup, bank);
-    return queues_[q_idx].size() < queue_size_;
+    return queues_[q_idx].size() + num_cmds <= queue_size_;
+}
+
+bool CommandQueue::WillAcceptRowRefresh(int num_cmds) const {
+    return row_refresh_queue_.size() + num_cmds <= queue_size_;
+}
+
+bool CommandQueue::HasBankCommand(int rank, int bankgroup, int bank) const {
+    auto same_bank = [&](const Command& cmd) {
+        return cmd.Rank() == rank && cmd.Bankgroup() == bankgroup &&
+               cmd.Bank() == bank;
+    };
+    const auto& queue = queues_[GetQueueIndex(rank, bankgroup, bank)];
+    return std::any_of(queue.begin(), queue.end(), same_bank) ||
+           std::any_of(row_refresh_queue_.begin(), row_refresh_queue_.end(),
+                       same_bank);
 }
 
 bool CommandQueue::QueueEmpty() const {
@@ -124,8 +172,14 @@ bool CommandQueue::QueueEmpty() const {
 }
 
 
+bool CommandQueue::IsIdle() const {
+    return QueueEmpty() && row_refresh_queue_.empty() && !is_in_ref_;
+}
+
 bool CommandQueue::AddCommand(Command cmd) {
-    auto& queue = GetQueue(cmd.Rank(), cmd.Bankgroup(), cmd.Bank());
+    auto& queue = cmd.cmd_type == CommandType::ROW_REFRESH
+                      ? row_refresh_queue_
+                      : GetQueue(cmd.Rank(), cmd.Bankgroup(), cmd.Bank());
     if (queue.size() < queue_size_) {
         queue.push_back(cmd);
         rank_q_empty[cmd.Rank()] = false;
@@ -185,6 +239,11 @@ Command CommandQueue::GetFirstReadyInQueue(CMDQueue& queue) const {
             if (!ArbitratePrecharge(cmd_it, queue)) {
                 continue;
             }
+        } else if (cmd.cmd_type == CommandType::ACTIVATE) {
+            if ((throttle_ && throttle_->isActivationDelayed(cmd.addr, clk_)) ||
+                (hold_ && hold_(cmd))) {
+                continue;
+            }
         } else if (cmd.IsWrite()) {
             if (HasRWDependency(cmd_it, queue)) {
                 continue;
@@ -1,6 +1,7 @@
 #ifndef __COMMAND_QUEUE_H
 #define __COMMAND_QUEUE_H
 
+#include <functional>
 #include <unordered_set>
 #include <vector>
 #include "channel_state.h"
@@ -14,6 +15,8 @@ using CMDIterator = std::vector<Command>::iterator;
 using CMDQueue = std::vector<Command>;
 enum class QueueStructure { PER_RANK, PER_BANK, SIZE };
 
+class Rowhammer;
+
 class CommandQueue {
    public:
     CommandQueue(int channel_id, const Config& config,
@@ -21,9 +24,22 @@ class CommandQueue {
     Command GetCommandToIssue();
     Command FinishRefresh();
     void ClockTick() { clk_ += 1; };
-    bool WillAcceptCommand(int rank, int bankgroup, int bank) const;
+    void SkipCycles(uint64_t cycles) { clk_ += cycles; }
+    bool WillAcceptCommand(int rank, int bankgroup, int bank,
+                           int num_cmds = 1) const;
+    bool WillAcceptRowRefresh(int num_cmds = 1) const;
+    bool HasBankCommand(int rank, int bankgroup, int bank) const;
     bool AddCommand(Command cmd);
+    // rowhammer engine that may hold back ACTs, owned by the controller
+    void SetThrottle(Rowhammer* throttle) { throttle_ = throttle; }
+    // ACTs the controller holds back on top of the throttle, e.g. while
+    // its mitigation queue is full
+    void SetActivationHold(std::function<bool(const Command&)> hold) {
+        hold_ = hold;
+    }
     bool QueueEmpty() const;
+    // no command of any kind, and no refresh in progress
+    bool IsIdle() const;
     int QueueUsage() const;
     std::vector<bool> rank_q_empty;
 
@@ -38,6 +54,7 @@ class CommandQueue {
     CMDQueue& GetNextQueue();
     void GetRefQIndices(const Command& ref);
     void EraseRWCommand(const Command& cmd);
+    Command GetReadyRowRefresh();
     Command PrepRefCmd(const CMDIterator& it, const Command& ref) const;
 
     QueueStructure queue_structure_;
@@ -46,11 +63,16 @@ class CommandQueue {
     SimpleStats& simple_stats_;
 
     std::vector<CMDQueue> queues_;
+    // rowhammer victim refreshes, served before the queues above
+    CMDQueue row_refresh_queue_;
 
     // Refresh related data structures
     std::unordered_set<int> ref_q_indices_;
     bool is_in_ref_;
 
+    Rowhammer* throttle_;
+    std::function<bool(const Command&)> hold_;
+
     int num_queues_;
     size_t queue_size_;
     int queue_idx_;
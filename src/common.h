@@ -58,8 +58,10 @@ enum class CommandType {
     WRITE_PRECHARGE,
     ACTIVATE,
     PRECHARGE,
+    ROW_REFRESH,  // ACT + PRE of a victim row, no column access
     REFRESH_BANK,
     REFRESH,
+    RFM,  // DDR5 refresh management, per bank
     SREF_ENTER,
     SREF_EXIT,
     SIZE
@@ -111,24 +113,40 @@ struct Transaction {
           added_cycle(0),
           complete_cycle(0),
           is_write(is_write), 
-          is_NEI_ACT(false) {}
+          is_NEI_ACT(false),
+          is_counter(false),
+          is_swap(false),
+          source(-1) {}
     Transaction(uint64_t addr, bool is_write, bool is_NEI_ACT)
         : addr(addr),
           added_cycle(0),
           complete_cycle(0),
           is_write(is_write), 
-          is_NEI_ACT(is_NEI_ACT) {}
+          is_NEI_ACT(is_NEI_ACT),
+          is_counter(false),
+          is_swap(false),
+          source(-1) {}
     Transaction(const Transaction& tran)
         : addr(tran.addr),
           added_cycle(tran.added_cycle),
           complete_cycle(tran.complete_cycle),
           is_write(tran.is_write),
-          is_NEI_ACT(tran.is_NEI_ACT) {}
+          is_NEI_ACT(tran.is_NEI_ACT),
+          is_counter(tran.is_counter),
+          is_swap(tran.is_swap),
+          source(tran.source) {}
     uint64_t addr;
     uint64_t added_cycle;
     uint64_t complete_cycle;
     bool is_write;
     bool is_NEI_ACT;
+    // rowhammer counter fill/write-back, generated by the controller
+    bool is_counter;
+    // RRS row swap read-out/write-back, to physical rows
+    bool is_swap;
+    // issuer of the request, e.g. a core, handed back when it is done;
+    // -1 if none
+    int source;
 
     friend std::ostream& operator<<(std::ostream& os, const Transaction& trans);
     friend std::istream& operator>>(std::istream& is, Transaction& trans);
@@ -1,5 +1,6 @@
 #include "configuration.h"
 
+#include <algorithm>
 #include <vector>
 
 #ifdef THERMAL
@@ -24,6 +25,8 @@ Config::Config(std::string config_file, std::string out_dir)
     InitTimingParams();
     InitPowerParams();
     InitOtherParams();
+    InitRowhammerParams();
+    InitHammerParams();
 #ifdef THERMAL
     InitThermalParams();
 #endif  // THERMAL
@@ -41,6 +44,17 @@ Address Config::AddressMapping(uint64_t hex_addr) const {
     return Address(channel, rank, bg, ba, ro, co);
 }
 
+uint64_t Config::AddressInverseMapping(const Address& addr) const {
+    // column can be any value within range, the request is aligned anyway
+    uint64_t hex_addr = ((addr.channel & ch_mask) << ch_pos) |
+                        ((addr.rank & ra_mask) << ra_pos) |
+                        ((addr.bankgroup & bg_mask) << bg_pos) |
+                        ((addr.bank & ba_mask) << ba_pos) |
+                        ((addr.row & ro_mask) << ro_pos) |
+                        ((addr.column & co_mask) << co_pos);
+    return hex_addr << shift_bits;
+}
+
 void Config::CalculateSize() {
     // calculate rank and re-calculate channel_size
     devices_per_rank = bus_width / device_width;
@@ -160,6 +174,14 @@ void Config::InitOtherParams() {
     // 1: default value, adds epoch CSV output on level 0
     // 2: adds histogram outputs in a different CSV format
     output_level = reader.GetInteger("other", "output_level", 1);
+    hot_rows = GetInteger("other", "hot_rows", 0);
+    hot_rows_sketch_width = GetInteger("other", "hot_rows_sketch_width", 1024);
+    hot_rows_sketch_depth = GetInteger("other", "hot_rows_sketch_depth", 4);
+    if (hot_rows > 0 &&
+        (hot_rows_sketch_width < 1 || hot_rows_sketch_depth < 1)) {
+        std::cerr << "Invalid hot row sketch size" << std::endl;
+        AbruptExit(__FILE__, __LINE__);
+    }
     // Other Parameters
     // give a prefix instead of specify the output name one by one...
     // this would allow outputing to a directory and you can always override
@@ -180,6 +202,13 @@ void Config::InitOtherParams() {
     return;
 }
 
+void Config::SetOutputSuffix(const std::string& suffix) {
+    output_prefix += "_" + suffix;
+    json_stats_name = output_prefix + ".json";
+    json_epoch_name = output_prefix + "epoch.json";
+    txt_stats_name = output_prefix + ".txt";
+}
+
 void Config::InitPowerParams() {
     const auto& reader = *reader_;
     // Power-related parameters
@@ -206,6 +235,7 @@ void Config::InitPowerParams() {
     write_energy_inc = VDD * (IDD4W - IDD3N) * burst_cycle * devices;
     ref_energy_inc = VDD * (IDD5AB - IDD3N) * tRFC * devices;
     refb_energy_inc = VDD * (IDD5PB - IDD3N) * tRFCb * devices;
+    rfm_energy_inc = VDD * (IDD5PB - IDD3N) * tRFM * devices;
     // the following are added per cycle
     act_stb_energy_inc = VDD * IDD3N * devices;
     pre_stb_energy_inc = VDD * IDD2N * devices;
@@ -214,6 +244,99 @@ void Config::InitPowerParams() {
     return;
 }
 
+void Config::InitRowhammerParams() {
+    const auto& reader = *reader_;
+    // X (not applied), PRA, CRA, Graphene or BlockHammer, can be overridden from the command line
+    rowhammer_scheme = reader.Get("rowhammer", "scheme", "X");
+    pra_probability = reader.GetReal("rowhammer", "probability", 0.01);
+    rowhammer_seed = GetInteger("rowhammer", "seed", 0);
+    cra_threshold = GetInteger("rowhammer", "threshold", 25);
+    // dense: a counter for every row, sparse: only for the activated rows
+    cra_tracker = reader.Get("rowhammer", "tracker", "dense");
+    cra_refresh_reset = reader.GetBoolean("rowhammer", "refresh_reset", true);
+    // counters stored in DRAM and cached in the controller, misses and
+    // dirty evictions become real counter read/write requests
+    cra_cache_sets = GetInteger("rowhammer", "cache_sets", 0);
+    cra_cache_ways = GetInteger("rowhammer", "cache_ways", 8);
+    cra_counters_per_line =
+        GetInteger("rowhammer", "cache_counters_per_line", 32);
+    cra_cache_replacement = reader.Get("rowhammer", "cache_replacement", "LRU");
+    graphene_entries = GetInteger("rowhammer", "entries", 0);
+    rrs_swap_queue = GetInteger("rowhammer", "swap_queue", 4);
+    // e.g. blast_radius = 2 and blast_weights = 1,0.5 (Half-Double), rows
+    // at distance 2 every other mitigation; missing weights are 1
+    blast_radius = GetInteger("rowhammer", "blast_radius", 1);
+    std::string weights = reader.Get("rowhammer", "blast_weights", "");
+    blast_weights.assign(blast_radius > 0 ? blast_radius : 0, 1.0);
+    auto tokens = StringSplit(weights, ',');
+    if (blast_radius < 1 || static_cast<int>(tokens.size()) > blast_radius) {
+        std::cerr << "Invalid blast_radius " << blast_radius
+                  << " or blast_weights " << weights << std::endl;
+        AbruptExit(__FILE__, __LINE__);
+    }
+    for (size_t i = 0; i < tokens.size(); i++) {
+        blast_weights[i] = std::stod(tokens[i]);
+        if (blast_weights[i] < 0 || blast_weights[i] > 1) {
+            std::cerr << "blast_weights must be within 0..1" << std::endl;
+            AbruptExit(__FILE__, __LINE__);
+        }
+    }
+    hc_first = GetInteger("rowhammer", "hc_first", 0);
+    rfm = reader.GetBoolean("rowhammer", "rfm", false);
+    raaimt = GetInteger("rowhammer", "raaimt", 32);
+    raammt = GetInteger("rowhammer", "raammt", raaimt * 3);
+    rfm_postpone = reader.GetBoolean("rowhammer", "rfm_postpone", true);
+    if (rfm && (raaimt < 1 || raammt < raaimt)) {
+        std::cerr << "RFM requires 0 < raaimt <= raammt" << std::endl;
+        AbruptExit(__FILE__, __LINE__);
+    }
+    // counting Bloom filters of cbf_size counters per bank and filter
+    blockhammer_threshold =
+        GetInteger("rowhammer", "blockhammer_threshold", 32768);
+    blockhammer_blacklist = GetInteger("rowhammer", "blockhammer_blacklist",
+                                       blockhammer_threshold / 4);
+    blockhammer_cbf_size =
+        GetInteger("rowhammer", "blockhammer_cbf_size", 1024);
+    blockhammer_hashes = GetInteger("rowhammer", "blockhammer_hashes", 4);
+    if (blockhammer_blacklist < 1 ||
+        blockhammer_blacklist >= blockhammer_threshold ||
+        blockhammer_blacklist > UINT16_MAX || blockhammer_cbf_size < 1 ||
+        blockhammer_hashes < 1) {
+        std::cerr << "BlockHammer requires 0 < blockhammer_blacklist < "
+                  << "blockhammer_threshold and a non-empty filter"
+                  << std::endl;
+        AbruptExit(__FILE__, __LINE__);
+    }
+    // spread the remaining ACTs of a blacklisted row over the window
+    blockhammer_delay = std::max(
+        tRC, static_cast<int>((static_cast<int64_t>(tREFW) -
+                               static_cast<int64_t>(blockhammer_blacklist) *
+                                   tRC) /
+                              (blockhammer_threshold - blockhammer_blacklist)));
+    // in-DRAM TRR sampler, runs along with the scheme above;
+    // COUNTER: most activated rows, SAMPLE: most recent sampled rows
+    trr_entries = GetInteger("rowhammer", "trr_entries", 0);
+    trr_refreshes = GetInteger("rowhammer", "trr_refreshes", 1);
+    trr_policy = reader.Get("rowhammer", "trr_policy", "COUNTER");
+    trr_probability = reader.GetReal("rowhammer", "trr_probability", 0.1);
+    return;
+}
+
+void Config::InitHammerParams() {
+    const auto& reader = *reader_;
+    // SINGLE: one aggressor alternating with a far row of the same bank,
+    // DOUBLE: the two rows around a victim, MANY: aggressors rows around
+    // aggressors - 1 victims
+    hammer_pattern = reader.Get("hammer", "pattern", "DOUBLE");
+    hammer_aggressors = GetInteger("hammer", "aggressors", 8);
+    // 0: back to back, one row cycle apart
+    hammer_interval = GetInteger("hammer", "interval", 0);
+    // NONE, RANDOM or STREAM requests issued in between with benign_ratio
+    hammer_benign = reader.Get("hammer", "benign", "NONE");
+    hammer_benign_ratio = reader.GetReal("hammer", "benign_ratio", 0.5);
+    return;
+}
+
 void Config::InitSystemParams() {
     const auto& reader = *reader_;
     channel_size = GetInteger("system", "channel_size", 1024);
@@ -322,6 +445,9 @@ void Config::InitTimingParams() {
     tRFCb = GetInteger("timing", "tRFCb", 20);
     tREFI = GetInteger("timing", "tREFI", 7800);
     tREFIb = GetInteger("timing", "tREFIb", 1950);
+    // every row is refreshed once per window, 8192 REFs by JEDEC
+    tREFW = GetInteger("timing", "tREFW", tREFI * 8192);
+    tRFM = GetInteger("timing", "tRFM", tRFCb);
     tFAW = GetInteger("timing", "tFAW", 50);
     tRPRE = GetInteger("timing", "tRPRE", 1);
     tWPRE = GetInteger("timing", "tWPRE", 1);
@@ -3,6 +3,7 @@
 
 #include <fstream>
 #include <string>
+#include <vector>
 #include "common.h"
 
 #include "INIReader.h"
@@ -35,6 +36,9 @@ class Config {
    public:
     Config(std::string config_file, std::string out_dir);
     Address AddressMapping(uint64_t hex_addr) const;
+    uint64_t AddressInverseMapping(const Address& addr) const;
+    // keeps the outputs of several memory systems in one directory apart
+    void SetOutputSuffix(const std::string& suffix);
     // DRAM physical structure
     DRAMProtocol protocol;
     int channel_size;
@@ -86,6 +90,8 @@ class Config {
     int tRFCb;
     int tREFI;
     int tREFIb;
+    int tREFW;
+    int tRFM;
     int tFAW;
     int tRPRE;  // read preamble and write preamble are important
     int tWPRE;
@@ -106,6 +112,7 @@ class Config {
     double write_energy_inc;
     double ref_energy_inc;
     double refb_energy_inc;
+    double rfm_energy_inc;
     double act_stb_energy_inc;
     double pre_stb_energy_inc;
     double pre_pd_energy_inc;
@@ -134,8 +141,66 @@ class Config {
     bool aggressive_precharging_enabled;
     bool enable_hbm_dual_cmd;
 
+    // Rowhammer mitigation
+    std::string rowhammer_scheme;
+    double pra_probability;
+    // seed of the random streams of PRA and the TRR sampler
+    int rowhammer_seed;
+    int cra_threshold;
+    std::string cra_tracker;
+    // CRA counts restart once the row has been refreshed
+    bool cra_refresh_reset;
+    // CRA counter cache, 0 sets means counters are accessed for free
+    int cra_cache_sets;
+    int cra_cache_ways;
+    int cra_counters_per_line;
+    std::string cra_cache_replacement;
+    // Graphene table entries per bank, 0 sizes it from the threshold
+    int graphene_entries;
+    // RRS swaps pending in a channel, the one in flight included
+    int rrs_swap_queue;
+    // rows refreshed on each side of an aggressor, distance d is part of
+    // a mitigation at rate blast_weights[d - 1] (0..1)
+    int blast_radius;
+    std::vector<double> blast_weights;
+    // activations of the rows within the blast radius a row tolerates
+    // between refreshes, checked by the disturbance oracle (0, the
+    // default, disables it)
+    int hc_first;
+    // DDR5 refresh management: an RFM is due once the rolling activation
+    // count of a bank reaches raaimt and can be postponed up to raammt
+    bool rfm;
+    int raaimt;
+    int raammt;
+    bool rfm_postpone;
+    // BlockHammer: rows activated blockhammer_blacklist times within a
+    // refresh window are throttled to one ACT every blockhammer_delay
+    // cycles, derived so they stay below blockhammer_threshold ACTs
+    int blockhammer_threshold;
+    int blockhammer_blacklist;
+    int blockhammer_cbf_size;
+    int blockhammer_hashes;
+    int blockhammer_delay;
+    // in-DRAM TRR, 0 entries disables it
+    int trr_entries;
+    int trr_refreshes;
+    std::string trr_policy;
+    double trr_probability;
+
+    // HammerCPU attack generator, hammer_aggressors is used by the MANY
+    // sided pattern only
+    std::string hammer_pattern;
+    int hammer_aggressors;
+    int hammer_interval;
+    std::string hammer_benign;
+    double hammer_benign_ratio;
 
     int epoch_period;
+    // hot_rows most activated rows per bank in the JSON stats, estimated
+    // with a count-min sketch of depth x width counters (0 disables it)
+    int hot_rows;
+    int hot_rows_sketch_width;
+    int hot_rows_sketch_depth;
     int output_level;
     std::string output_dir;
     std::string output_prefix;
@@ -191,6 +256,8 @@ class Config {
     void InitDRAMParams();
     void InitOtherParams();
     void InitPowerParams();
+    void InitRowhammerParams();
+    void InitHammerParams();
     void InitSystemParams();
 #ifdef THERMAL
     void InitThermalParams();
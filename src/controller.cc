@@ -22,6 +22,12 @@ Controller::Controller(int channel, const Config &config, const Timing &timing)
       thermal_calc_(thermal_calc),
 #endif  // THERMAL
       is_unified_queue_(config.unified_queue),
+      rowhammer_(GetRowhammer(config, &simple_stats_)),
+      trr_(GetTRR(config, &simple_stats_)),
+      oracle_(GetDisturbanceOracle(config, &simple_stats_)),
+      epoch_hot_rows_(config.hot_rows > 0 ? new HotRowProfiler(config)
+                                          : nullptr),
+      hot_rows_(config.hot_rows > 0 ? new HotRowProfiler(config) : nullptr),
       row_buf_policy_(config.row_buf_policy == "CLOSE_PAGE"
                           ? RowBufPolicy::CLOSE_PAGE
                           : RowBufPolicy::OPEN_PAGE),
@@ -33,6 +39,11 @@ Controller::Controller(int channel, const Config &config, const Timing &timing)
         read_queue_.reserve(config_.trans_queue_size);
         write_buffer_.reserve(config_.trans_queue_size);
     }
+    cmd_queue_.SetThrottle(rowhammer_);
+    if (rowhammer_) {
+        cmd_queue_.SetActivationHold(std::bind(
+            &Controller::IsActivationHeld, this, std::placeholders::_1));
+    }
 
 #ifdef CMD_TRACE
     std::string trace_file_name = config_.output_prefix + "ch_" +
@@ -42,21 +53,33 @@ Controller::Controller(int channel, const Config &config, const Timing &timing)
 #endif  // CMD_TRACE
 }
 
-std::pair<uint64_t, int> Controller::ReturnDoneTrans(uint64_t clk) {
+Controller::~Controller() {
+    delete rowhammer_;
+    delete trr_;
+    delete oracle_;
+    delete epoch_hot_rows_;
+    delete hot_rows_;
+}
+
+std::pair<uint64_t, int> Controller::ReturnDoneTrans(uint64_t clk,
+                                                     int *source) {
     auto it = return_queue_.begin();
     while (it != return_queue_.end()) {
         // if transaction "it" is done
         if (clk >= it->complete_cycle) {
             if (it->is_write) {
                 simple_stats_.Increment("num_writes_done");
-            } else if (it->is_NEI_ACT) {
-                simple_stats_.Increment("num_NEI_ACT_cmds");
-                simple_stats_.AddValue("read_latency", clk_ - it->added_cycle);
+            } else if (it->is_counter || it->is_swap) {
+                it = return_queue_.erase(it);
+                continue;
             } else {
                 simple_stats_.Increment("num_reads_done");
                 simple_stats_.AddValue("read_latency", clk_ - it->added_cycle);
             }
             auto pair = std::make_pair(it->addr, it->is_write);
+            if (source) {
+                *source = it->source;
+            }
             it = return_queue_.erase(it);
             return pair;
         } else {
@@ -71,6 +94,18 @@ void Controller::ClockTick() {
     // update refresh counter
     refresh_.ClockTick();
 
+    // a postponed RFM is issued once nothing is waiting for its bank
+    if (config_.rfm && !channel_state_.IsRefreshWaiting()) {
+        for (const auto &addr : channel_state_.PostponedRFMs()) {
+            if (!cmd_queue_.HasBankCommand(addr.rank, addr.bankgroup,
+                                           addr.bank)) {
+                channel_state_.BankNeedRFM(addr.rank, addr.bankgroup,
+                                           addr.bank, true);
+                break;
+            }
+        }
+    }
+
     bool cmd_issued = false;
     Command cmd;
     if (channel_state_.IsRefreshWaiting()) {
@@ -153,8 +188,62 @@ void Controller::ClockTick() {
     return;
 }
 
-bool Controller::WillAcceptTransaction(uint64_t hex_addr, bool is_write) const {
-    if (is_unified_queue_) {
+uint64_t Controller::IdleCycles() const {
+    // writes may wait in the buffer as long as no drain can start
+    bool writes_waiting =
+        !write_buffer_.empty() &&
+        (write_draining_ > 0 || write_buffer_.size() > 8 ||
+         write_buffer_.size() >= write_buffer_.capacity() ||
+         pending_wr_q_.size() != write_buffer_.size());
+    if (!unified_queue_.empty() || !read_queue_.empty() || writes_waiting ||
+        !pending_rd_q_.empty() || !return_queue_.empty() ||
+        !mitigation_queue_.empty() || !cmd_queue_.IsIdle() ||
+        channel_state_.IsRefreshWaiting() ||
+        (config_.rfm && !channel_state_.PostponedRFMs().empty())) {
+        return 0;
+    }
+    uint64_t cycles = refresh_.CyclesToRefresh();
+    if (config_.enable_self_refresh) {
+        // up to the cycle an idle rank reaches the self-refresh threshold
+        for (int i = 0; i < config_.ranks; i++) {
+            if (channel_state_.IsRankSelfRefreshing(i) ||
+                !channel_state_.IsAllBankIdleInRank(i)) {
+                continue;
+            }
+            int left = config_.sref_threshold - 1 -
+                       channel_state_.rank_idle_cycles[i];
+            cycles = std::min<uint64_t>(cycles, std::max(left, 0));
+        }
+    }
+    return cycles;
+}
+
+void Controller::SkipCycles(uint64_t cycles) {
+    refresh_.SkipCycles(cycles);
+    for (int i = 0; i < config_.ranks; i++) {
+        if (channel_state_.IsRankSelfRefreshing(i)) {
+            simple_stats_.IncrementVecBy("sref_cycles", i, cycles);
+        } else if (channel_state_.IsAllBankIdleInRank(i)) {
+            simple_stats_.IncrementVecBy("all_bank_idle_cycles", i, cycles);
+            channel_state_.rank_idle_cycles[i] += cycles;
+        } else {
+            simple_stats_.IncrementVecBy("rank_active_cycles", i, cycles);
+            channel_state_.rank_idle_cycles[i] = 0;
+        }
+    }
+    clk_ += cycles;
+    cmd_queue_.SkipCycles(cycles);
+    simple_stats_.IncrementBy("num_cycles", cycles);
+}
+
+bool Controller::WillAcceptTransaction(uint64_t hex_addr, bool is_write,
+                                       bool is_NEI_ACT) const {
+    if (is_NEI_ACT) {
+        // NEI_ACTs of a converted trace wait along with the bursts of the
+        // controller's own mitigation
+        return mitigation_queue_.size() <
+               static_cast<size_t>(config_.trans_queue_size);
+    } else if (is_unified_queue_) {
         return unified_queue_.size() < unified_queue_.capacity();
     } else if (!is_write) {
         return read_queue_.size() < read_queue_.capacity();
@@ -168,7 +257,11 @@ bool Controller::AddTransaction(Transaction trans) {
     simple_stats_.AddValue("interarrival_latency", clk_ - last_trans_clk_);
     last_trans_clk_ = clk_;
 
-    if (trans.is_write) {
+    if (trans.is_NEI_ACT) {
+        // NEI_ACT of a converted trace, nothing is returned to the CPU
+        mitigation_queue_.push_back({trans});
+        return true;
+    } else if (trans.is_write) {
         if (pending_wr_q_.count(trans.addr) == 0) {  // can not merge writes
             pending_wr_q_.insert(std::make_pair(trans.addr, trans));
             if (is_unified_queue_) {
@@ -200,6 +293,21 @@ bool Controller::AddTransaction(Transaction trans) {
 }
 
 void Controller::ScheduleTransaction() {
+    // neighbor activations and counter traffic go ahead of regular requests
+    if (WillAcceptMitigation()) {
+        auto &burst = mitigation_queue_.front();
+        int num_cmds = std::min(static_cast<int>(burst.size()),
+                                config_.cmd_queue_size);
+        for (int i = 0; i < num_cmds; i++) {
+            cmd_queue_.AddCommand(TransToCommand(burst[i]));
+        }
+        burst.erase(burst.begin(), burst.begin() + num_cmds);
+        if (burst.empty()) {
+            mitigation_queue_.erase(mitigation_queue_.begin());
+        }
+        return;
+    }
+
     // determine whether to schedule read or write
     if (write_draining_ == 0 && !is_unified_queue_) {
         // we basically have a upper and lower threshold for write buffer
@@ -247,13 +355,21 @@ void Controller::IssueCommand(const Command &cmd) {
             exit(1);
         }
         // if there are multiple reads pending return them all
+        bool counter_traffic = false;
         while (num_reads > 0) {
             auto it = pending_rd_q_.find(cmd.hex_addr);
             it->second.complete_cycle = clk_ + config_.read_delay;
             return_queue_.push_back(it->second);
+            if (it->second.is_counter || it->second.is_swap) {
+                rowhammer_->counterTrafficDone(it->second);
+                counter_traffic = true;
+            }
             pending_rd_q_.erase(it);
             num_reads -= 1;
         }
+        if (counter_traffic) {
+            QueueCounterTraffic();
+        }
     } else if (cmd.IsWrite()) {
         // there should be only 1 write to the same location at a time
         auto it = pending_wr_q_.find(cmd.hex_addr);
@@ -261,19 +377,158 @@ void Controller::IssueCommand(const Command &cmd) {
             std::cerr << cmd.hex_addr << " not in write queue!" << std::endl;
             exit(1);
         }
-        auto wr_lat = clk_ - it->second.added_cycle + config_.write_delay;
-        simple_stats_.AddValue("write_latency", wr_lat);
+        Transaction trans(it->second);
         pending_wr_q_.erase(it);
+        if (!trans.is_counter && !trans.is_swap) {
+            auto wr_lat = clk_ - trans.added_cycle + config_.write_delay;
+            simple_stats_.AddValue("write_latency", wr_lat);
+        } else {
+            rowhammer_->counterTrafficDone(trans);
+            QueueCounterTraffic();
+        }
     }
     // must update stats before states (for row hits)
     UpdateCommandStats(cmd);
     channel_state_.UpdateTimingAndStates(cmd, clk_);
+    // the oracle sees every activation, counter and swap traffic included
+    if (oracle_ && (cmd.cmd_type == CommandType::ACTIVATE ||
+                    cmd.cmd_type == CommandType::ROW_REFRESH)) {
+        oracle_->updateInfo(cmd.addr, clk_);
+    } else if (oracle_ && cmd.IsRefresh()) {
+        oracle_->updateRefresh(cmd.addr);
+    }
+    // activations issued for the mitigation itself are not counted
+    if (cmd.cmd_type == CommandType::ACTIVATE &&
+        (rowhammer_ || trr_) && !IsMitigationActivation(cmd)) {
+        if (rowhammer_) {
+            MitigateRowhammer(cmd);
+        }
+        if (trr_) {
+            trr_->updateInfo(cmd.addr, clk_);
+        }
+    } else if (rowhammer_ && cmd.IsRefresh()) {
+        rowhammer_->updateRefresh(cmd.addr);
+    }
+    // RFM gives the DRAM time for the same in-DRAM mitigation
+    if (trr_ && (cmd.IsRefresh() || cmd.cmd_type == CommandType::RFM)) {
+        trr_->updateRefresh(cmd.addr);
+        RefreshTRRVictims();
+    }
 }
 
-Command Controller::TransToCommand(const Transaction &trans) {
+void Controller::RefreshTRRVictims() {
+    // the DRAM refreshes them itself within the tRFC (or tRFM) of the
+    // command, trr_refreshes aggressors per bank fit in it; no command
+    // bus or tFAW slot is taken and the energy is that of the refresh
+    for (const auto &aggressor : trr_->takeRefreshAggressors()) {
+        for (const auto &victim : trr_->neighborRows(aggressor)) {
+            simple_stats_.Increment("num_trr_victim_refreshes");
+            if (oracle_) {
+                oracle_->updateInfo(victim, clk_);
+            }
+        }
+    }
+}
+
+bool Controller::IsMitigationActivation(const Command &cmd) const {
+    // victim refreshes are ROW_REFRESH commands, only counter and swap
+    // traffic activates rows here
+    auto rd_it = pending_rd_q_.find(cmd.hex_addr);
+    if (rd_it != pending_rd_q_.end() &&
+        (rd_it->second.is_counter || rd_it->second.is_swap)) {
+        return true;
+    }
+    auto wr_it = pending_wr_q_.find(cmd.hex_addr);
+    return wr_it != pending_wr_q_.end() &&
+           (wr_it->second.is_counter || wr_it->second.is_swap);
+}
+
+bool Controller::WillAcceptMitigation() const {
+    if (mitigation_queue_.empty()) {
+        return false;
+    }
+    // all rows of a burst share the bank (and command queue)
+    const auto &burst = mitigation_queue_.front();
+    auto cmd = TransToCommand(burst.front());
+    int num_cmds =
+        std::min(static_cast<int>(burst.size()), config_.cmd_queue_size);
+    return cmd.cmd_type == CommandType::ROW_REFRESH
+               ? cmd_queue_.WillAcceptRowRefresh(num_cmds)
+               : cmd_queue_.WillAcceptCommand(cmd.Rank(), cmd.Bankgroup(),
+                                              cmd.Bank(), num_cmds);
+}
+
+bool Controller::IsActivationHeld(const Command &cmd) const {
+    // a full queue that is draining holds back the ACTs of regular
+    // requests; if its front waits for the command queue (e.g. behind
+    // requests of its bank) they go on, or neither could move
+    return mitigation_queue_.size() >=
+               static_cast<size_t>(config_.trans_queue_size) &&
+           !IsMitigationActivation(cmd) && WillAcceptMitigation();
+}
+
+void Controller::MitigateRowhammer(const Command &cmd) {
+    rowhammer_->updateInfo(cmd.addr, clk_);
+    QueueCounterTraffic();
+    if (!rowhammer_->isInsertionRequired()) {
+        return;
+    }
+    simple_stats_.Increment("num_rowhammer_mitigations");
+    InsertNeighborActivations(cmd.addr);
+}
+
+void Controller::QueueCounterTraffic() {
+    // the engine may answer a served request with more of them
+    auto traffic = rowhammer_->takeCounterTraffic();
+    while (!traffic.empty()) {
+        for (auto &trans : traffic) {
+            trans.added_cycle = clk_;
+            if (trans.is_write) {
+                simple_stats_.Increment(trans.is_swap ? "num_swap_writes"
+                                                      : "num_counter_writes");
+                if (pending_wr_q_.count(trans.addr) == 0) {
+                    pending_wr_q_.insert(std::make_pair(trans.addr, trans));
+                    mitigation_queue_.push_back({trans});
+                } else {
+                    rowhammer_->counterTrafficDone(trans);
+                }
+            } else {
+                simple_stats_.Increment(trans.is_swap ? "num_swap_reads"
+                                                      : "num_counter_reads");
+                pending_rd_q_.insert(std::make_pair(trans.addr, trans));
+                if (pending_rd_q_.count(trans.addr) == 1) {
+                    mitigation_queue_.push_back({trans});
+                }
+            }
+        }
+        traffic = rowhammer_->takeCounterTraffic();
+    }
+}
+
+void Controller::InsertNeighborActivations(const Address &aggressor) {
+    std::vector<Transaction> burst;
+    for (const auto &nei_addr : rowhammer_->neighborRows(aggressor)) {
+        Transaction trans(config_.AddressInverseMapping(nei_addr), false, true);
+        trans.added_cycle = clk_;
+        burst.push_back(trans);
+    }
+    if (!burst.empty()) {
+        simple_stats_.AddValue("mitigation_burst_size", burst.size());
+        mitigation_queue_.push_back(burst);
+    }
+}
+
+Command Controller::TransToCommand(const Transaction &trans) const {
     auto addr = config_.AddressMapping(trans.addr);
+    if (rowhammer_ && !trans.is_counter && !trans.is_swap &&
+        !trans.is_NEI_ACT) {
+        // counter, swap and neighbor traffic already addresses physical rows
+        addr.row = rowhammer_->physicalRow(addr);
+    }
     CommandType cmd_type;
-    if (row_buf_policy_ == RowBufPolicy::OPEN_PAGE) {
+    if (trans.is_NEI_ACT) {
+        cmd_type = CommandType::ROW_REFRESH;
+    } else if (row_buf_policy_ == RowBufPolicy::OPEN_PAGE) {
         cmd_type = trans.is_write ? CommandType::WRITE : CommandType::READ;
     } else {
         cmd_type = trans.is_write ? CommandType::WRITE_PRECHARGE
@@ -286,6 +541,10 @@ int Controller::QueueUsage() const { return cmd_queue_.QueueUsage(); }
 
 void Controller::PrintEpochStats() {
     simple_stats_.Increment("epoch_num");
+    if (epoch_hot_rows_) {
+        simple_stats_.SetJsonStat("hot_rows", epoch_hot_rows_->ToJson());
+        epoch_hot_rows_->Reset();
+    }
     simple_stats_.PrintEpochStats();
 #ifdef THERMAL
     for (int r = 0; r < config_.ranks; r++) {
@@ -297,6 +556,12 @@ void Controller::PrintEpochStats() {
 }
 
 void Controller::PrintFinalStats() {
+    if (rowhammer_) {
+        rowhammer_->finishStats();
+    }
+    if (hot_rows_) {
+        simple_stats_.SetJsonStat("hot_rows", hot_rows_->ToJson());
+    }
     simple_stats_.PrintFinalStats();
 
 #ifdef THERMAL
@@ -328,16 +593,26 @@ void Controller::UpdateCommandStats(const Command &cmd) {
             break;
         case CommandType::ACTIVATE:
             simple_stats_.Increment("num_act_cmds");
+            if (hot_rows_) {
+                epoch_hot_rows_->AddActivation(cmd.addr);
+                hot_rows_->AddActivation(cmd.addr);
+            }
             break;
         case CommandType::PRECHARGE:
             simple_stats_.Increment("num_pre_cmds");
             break;
+        case CommandType::ROW_REFRESH:
+            simple_stats_.Increment("num_NEI_ACT_cmds");
+            break;
         case CommandType::REFRESH:
             simple_stats_.Increment("num_ref_cmds");
             break;
         case CommandType::REFRESH_BANK:
             simple_stats_.Increment("num_refb_cmds");
             break;
+        case CommandType::RFM:
+            simple_stats_.Increment("num_rfm_cmds");
+            break;
         case CommandType::SREF_ENTER:
             simple_stats_.Increment("num_srefe_cmds");
             break;
@@ -8,7 +8,9 @@
 #include "channel_state.h"
 #include "command_queue.h"
 #include "common.h"
+#include "hot_row_profiler.h"
 #include "refresh.h"
+#include "rowhammer.h"
 #include "simple_stats.h"
 
 #ifdef THERMAL
@@ -27,15 +29,27 @@ class Controller {
 #else
     Controller(int channel, const Config &config, const Timing &timing);
 #endif  // THERMAL
+    ~Controller();
     void ClockTick();
-    bool WillAcceptTransaction(uint64_t hex_addr, bool is_write) const;
+    // cycles from now in which a ClockTick would only count cycles: no
+    // command can be scheduled and no refresh or self-refresh entry is
+    // due; 0 if busy
+    uint64_t IdleCycles() const;
+    // ticks over that many idle cycles in one step
+    void SkipCycles(uint64_t cycles);
+    bool WillAcceptTransaction(uint64_t hex_addr, bool is_write,
+                               bool is_NEI_ACT) const;
     bool AddTransaction(Transaction trans);
     int QueueUsage() const;
     // Stats output
     void PrintEpochStats();
     void PrintFinalStats();
     void ResetStats() { simple_stats_.Reset(); }
-    std::pair<uint64_t, int> ReturnDoneTrans(uint64_t clock);
+    double GetStat(const std::string &name) const {
+        return simple_stats_.GetStat(name);
+    }
+    std::pair<uint64_t, int> ReturnDoneTrans(uint64_t clock,
+                                             int *source = nullptr);
 
     int channel_id_;
 
@@ -64,6 +78,23 @@ class Controller {
     // completed transactions
     std::vector<Transaction> return_queue_;
 
+    // rowhammer mitigation, nullptr if not applied
+    Rowhammer *rowhammer_;
+    // in-DRAM TRR, nullptr if disabled
+    Rowhammer *trr_;
+    // per row disturbance, nullptr if disabled
+    DisturbanceOracle *oracle_;
+
+    // hot rows of the current epoch and of the whole run, nullptr if
+    // not profiled
+    HotRowProfiler *epoch_hot_rows_;
+    HotRowProfiler *hot_rows_;
+    // neighbor activations and counter fills/write-backs waiting to be
+    // scheduled, prior to other requests; the neighbors of an aggressor
+    // form one burst that enters the command queue at once. Once it holds
+    // trans_queue_size entries, the ACTs that could add to it wait
+    std::vector<std::vector<Transaction>> mitigation_queue_;
+
     // row buffer policy
     RowBufPolicy row_buf_policy_;
 
@@ -78,8 +109,15 @@ class Controller {
     int write_draining_;
     void ScheduleTransaction();
     void IssueCommand(const Command &tmp_cmd);
-    Command TransToCommand(const Transaction &trans);
+    Command TransToCommand(const Transaction &trans) const;
     void UpdateCommandStats(const Command &cmd);
+    bool IsMitigationActivation(const Command &cmd) const;
+    bool WillAcceptMitigation() const;
+    bool IsActivationHeld(const Command &cmd) const;
+    void MitigateRowhammer(const Command &cmd);
+    void QueueCounterTraffic();
+    void InsertNeighborActivations(const Address &aggressor);
+    void RefreshTRRVictims();
 };
 }  // namespace dramsim3
 #endif
@@ -1,7 +1,25 @@
 #include "cpu.h"
 
+#include <algorithm>
+#include <iomanip>
+#include <numeric>
+#include "json.hpp"
+
 namespace dramsim3 {
 
+uint64_t CPU::FastForward(uint64_t limit) {
+    uint64_t next = NextRequestCycle();
+    if (next <= clk_) {
+        return 0;
+    }
+    uint64_t cycles = memory_system_.IdleCycles(std::min(limit, next - clk_));
+    if (cycles > 0) {
+        memory_system_.SkipCycles(cycles);
+        clk_ += cycles;
+    }
+    return cycles;
+}
+
 void RandomCPU::ClockTick() {
     // Create random CPU requests at full speed
     // this is useful to exploit the parallelism of a DRAM protocol
@@ -59,27 +77,146 @@ void StreamCPU::ClockTick() {
     return;
 }
 
+HammerCPU::HammerCPU(const Config& config, const std::string& output_dir)
+    : CPU(config, output_dir),
+      interval_(config.hammer_interval > 0 ? config.hammer_interval
+                                           : config.tRC),
+      benign_(config.hammer_benign),
+      benign_dist_(config.hammer_benign_ratio) {
+    int num_aggressors = 0;
+    if (config.hammer_pattern == "SINGLE") {
+        num_aggressors = 1;
+    } else if (config.hammer_pattern == "DOUBLE") {
+        num_aggressors = 2;
+    } else if (config.hammer_pattern == "MANY") {
+        num_aggressors = config.hammer_aggressors;
+    } else {
+        std::cerr << "Unknown hammer pattern " << config.hammer_pattern
+                  << std::endl;
+        AbruptExit(__FILE__, __LINE__);
+    }
+    if (num_aggressors < 1 || 2 * num_aggressors - 1 > config.rows) {
+        std::cerr << "Invalid number of hammer aggressors " << num_aggressors
+                  << std::endl;
+        AbruptExit(__FILE__, __LINE__);
+    }
+    if ((benign_ != "NONE" && benign_ != "RANDOM" && benign_ != "STREAM") ||
+        config.hammer_benign_ratio < 0 || config.hammer_benign_ratio > 1) {
+        std::cerr << "Invalid hammer benign traffic " << benign_
+                  << " at ratio " << config.hammer_benign_ratio << std::endl;
+        AbruptExit(__FILE__, __LINE__);
+    }
+
+    // aggressors every other row, sandwiching the victims in between
+    Address addr(gen() % config.channels, gen() % config.ranks,
+                 gen() % config.bankgroups, gen() % config.banks_per_group,
+                 0, 0);
+    int base = gen() % (config.rows - 2 * num_aggressors + 2);
+    std::cout << "HammerCPU: " << config.hammer_pattern
+              << " sided, aggressor rows";
+    for (int i = 0; i < num_aggressors; i++) {
+        addr.row = base + 2 * i;
+        aggressors_.push_back(config.AddressInverseMapping(addr));
+        std::cout << " " << addr.row;
+    }
+    if (num_aggressors == 1) {
+        // a far row of the same bank closes the aggressor row every time
+        addr.row = (base + config.rows / 2) % config.rows;
+        aggressors_.push_back(config.AddressInverseMapping(addr));
+        std::cout << " (and " << addr.row << ")";
+    }
+    std::cout << " of channel " << addr.channel << " rank " << addr.rank
+              << " bankgroup " << addr.bankgroup << " bank " << addr.bank
+              << std::endl;
+    stream_addr_ = gen();
+}
+
+void HammerCPU::ClockTick() {
+    // one aggressor read every interval, the benign requests fill the
+    // cycles in between
+    memory_system_.ClockTick();
+    if (clk_ >= next_hammer_clk_ &&
+        memory_system_.WillAcceptTransaction(aggressors_[next_aggressor_],
+                                             false)) {
+        memory_system_.AddTransaction(aggressors_[next_aggressor_], false);
+        next_aggressor_ = (next_aggressor_ + 1) % aggressors_.size();
+        next_hammer_clk_ = clk_ + interval_;
+    } else if (benign_ != "NONE") {
+        if (get_next_benign_ && benign_dist_(gen)) {
+            get_next_benign_ = false;
+            if (benign_ == "RANDOM") {
+                benign_addr_ = gen();
+                benign_write_ = (gen() % 3 == 0);
+            } else {
+                benign_addr_ = stream_addr_;
+                benign_write_ = false;
+                stream_addr_ += stride_;
+            }
+        }
+        if (!get_next_benign_ &&
+            memory_system_.WillAcceptTransaction(benign_addr_,
+                                                 benign_write_)) {
+            memory_system_.AddTransaction(benign_addr_, benign_write_);
+            get_next_benign_ = true;
+        }
+    }
+    clk_++;
+    return;
+}
+
+uint64_t HammerCPU::NextRequestCycle() {
+    return benign_ == "NONE" ? next_hammer_clk_ : clk_;
+}
+
 TraceBasedCPU::TraceBasedCPU(const std::string& config_file,
                              const std::string& output_dir,
-                             const std::string& trace_file)
-    : CPU(config_file, output_dir) {
-    trace_file_.open(trace_file);
-    if (trace_file_.fail()) {
-        std::cerr << "Trace file does not exist" << std::endl;
-        AbruptExit(__FILE__, __LINE__);
+                             const std::string& trace_file, bool prefetch,
+                             uint64_t start_cycle)
+    : CPU(config_file, output_dir), start_cycle_(start_cycle) {
+    OpenTrace(trace_file, prefetch);
+}
+
+TraceBasedCPU::TraceBasedCPU(const Config& config,
+                             const std::string& output_dir,
+                             const std::string& trace_file, bool prefetch,
+                             uint64_t start_cycle)
+    : CPU(config, output_dir), start_cycle_(start_cycle) {
+    OpenTrace(trace_file, prefetch);
+}
+
+void TraceBasedCPU::OpenTrace(const std::string& trace_file, bool prefetch) {
+    if (start_cycle_ == 0 || GetTraceFormat(trace_file) != "compressed") {
+        trace_reader_ = GetTraceReader(trace_file, prefetch);
+        return;
+    }
+    // the block index skips the blocks before start_cycle_ undecoded
+    auto reader = new CompressedTraceReader(trace_file);
+    reader->SeekCycle(start_cycle_);
+    trace_reader_ = reader;
+    if (prefetch) {
+        trace_reader_ = new PrefetchTraceReader(reader);
+    }
+}
+
+void TraceBasedCPU::ReadNext() {
+    get_next_ = false;
+    do {
+        trace_done_ = !trace_reader_->Next(trans_);
+    } while (!trace_done_ && trans_.added_cycle < start_cycle_);
+    if (!trace_done_) {
+        trans_.added_cycle -= start_cycle_;
     }
 }
 
 void TraceBasedCPU::ClockTick() {
     memory_system_.ClockTick();
-    if (!trace_file_.eof()) {
-        if (get_next_) {
-            get_next_ = false;
-            trace_file_ >> trans_;
-        }
+    if (get_next_ && !trace_done_) {
+        ReadNext();
+    }
+    if (!trace_done_) {
         if (trans_.added_cycle <= clk_) {
-            get_next_ = memory_system_.WillAcceptTransaction(trans_.addr,
-                                                             trans_.is_write);
+            get_next_ = memory_system_.WillAcceptTransaction(
+                trans_.addr, trans_.is_write, trans_.is_NEI_ACT);
             if (get_next_) {
                 memory_system_.AddTransaction(trans_.addr, trans_.is_write, trans_.is_NEI_ACT);
             }
@@ -89,4 +226,331 @@ void TraceBasedCPU::ClockTick() {
     return;
 }
 
+uint64_t TraceBasedCPU::NextRequestCycle() {
+    // reads the request ClockTick would read next
+    if (get_next_ && !trace_done_) {
+        ReadNext();
+    }
+    return trace_done_ ? UINT64_MAX : trans_.added_cycle;
+}
+
+MultiTraceCPU::MultiTraceCPU(const Config& config,
+                             const std::string& output_dir,
+                             const std::vector<std::string>& trace_files,
+                             bool prefetch)
+    : CPU(config, output_dir),
+      cores_(trace_files.size()),
+      output_prefix_(config.output_prefix),
+      tCK_(config.tCK),
+      request_size_bytes_(config.request_size_bytes) {
+    for (size_t i = 0; i < trace_files.size(); i++) {
+        cores_[i].trace_file = trace_files[i];
+        cores_[i].trace_reader = GetTraceReader(trace_files[i], prefetch);
+        cores_[i].trace_done = !cores_[i].trace_reader->Next(cores_[i].trans);
+    }
+    memory_system_.RegisterSourceCallbacks(
+        std::bind(&MultiTraceCPU::ReadCallBack, this, std::placeholders::_1,
+                  std::placeholders::_2),
+        std::bind(&MultiTraceCPU::WriteCallBack, this, std::placeholders::_1,
+                  std::placeholders::_2));
+}
+
+MultiTraceCPU::~MultiTraceCPU() {
+    for (auto& core : cores_) {
+        delete core.trace_reader;
+    }
+}
+
+void MultiTraceCPU::ClockTick() {
+    memory_system_.ClockTick();
+    std::vector<int> due;
+    for (size_t i = 0; i < cores_.size(); i++) {
+        if (!cores_[i].trace_done && cores_[i].trans.added_cycle <= clk_) {
+            due.push_back(i);
+        }
+    }
+    // oldest request first, ties to the lower core
+    std::sort(due.begin(), due.end(), [this](int a, int b) {
+        return cores_[a].trans.added_cycle < cores_[b].trans.added_cycle ||
+               (cores_[a].trans.added_cycle == cores_[b].trans.added_cycle &&
+                a < b);
+    });
+    for (int i : due) {
+        Core& core = cores_[i];
+        const Transaction& trans = core.trans;
+        if (!memory_system_.WillAcceptTransaction(trans.addr, trans.is_write,
+                                                  trans.is_NEI_ACT)) {
+            core.stall_cycles++;
+            continue;
+        }
+        memory_system_.AddTransaction(trans.addr, trans.is_write,
+                                      trans.is_NEI_ACT, i);
+        // NEI_ACT of a converted trace are not returned
+        if (!trans.is_write && !trans.is_NEI_ACT) {
+            core.pending_reads.emplace_back(trans.addr, clk_);
+        }
+        core.reqs_issued++;
+        core.trace_done = !core.trace_reader->Next(core.trans);
+    }
+    clk_++;
+    return;
+}
+
+uint64_t MultiTraceCPU::NextRequestCycle() {
+    uint64_t next = UINT64_MAX;
+    for (const auto& core : cores_) {
+        if (!core.trace_done) {
+            next = std::min(next, core.trans.added_cycle);
+        }
+    }
+    return next;
+}
+
+void MultiTraceCPU::ReadCallBack(uint64_t addr, int core) {
+    // reads of a core to one address return in the order they were issued
+    auto& pending = cores_[core].pending_reads;
+    auto it = std::find_if(pending.begin(), pending.end(),
+                           [addr](const std::pair<uint64_t, uint64_t>& read) {
+                               return read.first == addr;
+                           });
+    if (it != pending.end()) {
+        cores_[core].reads_done++;
+        cores_[core].read_latency += clk_ - it->second;
+        pending.erase(it);
+    }
+}
+
+void MultiTraceCPU::WriteCallBack(uint64_t addr, int core) {
+    cores_[core].writes_done++;
+}
+
+void MultiTraceCPU::PrintStats() {
+    memory_system_.PrintStats();
+    nlohmann::json j_cores = nlohmann::json::array();
+    std::cout << "per-core stats over " << clk_ << " cycles" << std::endl;
+    std::cout << std::left << std::setw(6) << "core" << std::right
+              << std::setw(12) << "issued" << std::setw(12) << "reads_done"
+              << std::setw(12) << "writes_done" << std::setw(14)
+              << "avg_read_lat" << std::setw(14) << "bw(GB/s)"
+              << std::setw(14) << "stall_cycles" << "  trace" << std::endl;
+    std::cout << std::fixed;
+    for (size_t i = 0; i < cores_.size(); i++) {
+        const Core& core = cores_[i];
+        double avg_latency =
+            core.reads_done > 0
+                ? static_cast<double>(core.read_latency) / core.reads_done
+                : 0.0;
+        // bytes per ns
+        double bandwidth =
+            clk_ > 0 ? static_cast<double>(core.reads_done + core.writes_done) *
+                           request_size_bytes_ / (clk_ * tCK_)
+                     : 0.0;
+        std::cout << std::left << std::setw(6) << i << std::right
+                  << std::setw(12) << core.reqs_issued << std::setw(12)
+                  << core.reads_done << std::setw(12) << core.writes_done
+                  << std::setw(14) << std::setprecision(2) << avg_latency
+                  << std::setw(14) << std::setprecision(3) << bandwidth
+                  << std::setw(14) << core.stall_cycles << "  "
+                  << core.trace_file << std::endl;
+        nlohmann::json j_core;
+        j_core["core"] = i;
+        j_core["trace"] = core.trace_file;
+        j_core["reqs_issued"] = core.reqs_issued;
+        j_core["num_reads_done"] = core.reads_done;
+        j_core["num_writes_done"] = core.writes_done;
+        j_core["average_read_latency"] = avg_latency;
+        j_core["bandwidth"] = bandwidth;
+        j_core["stall_cycles"] = core.stall_cycles;
+        j_cores.push_back(j_core);
+    }
+    std::cout.unsetf(std::ios_base::floatfield);
+    std::cout << std::setprecision(6);
+    std::string cores_name = output_prefix_ + "cores.json";
+    std::ofstream cores_out(cores_name);
+    cores_out << j_cores.dump(2) << std::endl;
+}
+
+RunSummary GetRunSummary(const MemorySystem& memory_system) {
+    auto sum = [&memory_system](const std::string& name) {
+        auto stats = memory_system.GetChannelStats(name);
+        return std::accumulate(stats.begin(), stats.end(), 0.0);
+    };
+    // channel averages weighted by their reads
+    auto reads = memory_system.GetChannelStats("num_reads_done");
+    auto read_latency = memory_system.GetChannelStats("average_read_latency");
+    double read_cycles = 0;
+    for (size_t i = 0; i < reads.size(); i++) {
+        read_cycles += reads[i] * read_latency[i];
+    }
+    RunSummary summary;
+    double num_reads = sum("num_reads_done");
+    summary.reqs_done = num_reads + sum("num_writes_done");
+    summary.avg_read_latency = num_reads > 0 ? read_cycles / num_reads : 0;
+    summary.total_energy = sum("total_energy");
+    summary.nei_acts = sum("num_NEI_ACT_cmds");
+    return summary;
+}
+
+MemoryTraceCPU::MemoryTraceCPU(const Config& config,
+                               const std::string& output_dir,
+                               const std::vector<Transaction>& trace)
+    : CPU(config, output_dir), trace_(trace) {}
+
+void MemoryTraceCPU::ClockTick() {
+    memory_system_.ClockTick();
+    if (next_trans_ < trace_.size()) {
+        const auto& trans = trace_[next_trans_];
+        if (trans.added_cycle <= clk_ &&
+            memory_system_.WillAcceptTransaction(trans.addr, trans.is_write,
+                                                 trans.is_NEI_ACT)) {
+            memory_system_.AddTransaction(trans.addr, trans.is_write,
+                                          trans.is_NEI_ACT);
+            next_trans_++;
+        }
+    }
+    clk_++;
+    return;
+}
+
+uint64_t MemoryTraceCPU::NextRequestCycle() {
+    return next_trans_ < trace_.size() ? trace_[next_trans_].added_cycle
+                                       : UINT64_MAX;
+}
+
+LockstepTraceCPU::LockstepTraceCPU(const std::vector<Config>& configs,
+                                   const std::vector<std::string>& labels,
+                                   const std::string& output_dir,
+                                   const std::string& trace_file,
+                                   bool prefetch)
+    : CPU(configs[0], output_dir),
+      labels_(labels),
+      next_trans_(configs.size(), 0),
+      drained_(configs.size(), 0) {
+    trace_reader_ = GetTraceReader(trace_file, prefetch);
+    systems_.push_back(&memory_system_);
+    for (size_t i = 1; i < configs.size(); i++) {
+        systems_.push_back(new MemorySystem(
+            configs[i], output_dir,
+            std::bind(&CPU::ReadCallBack, this, std::placeholders::_1),
+            std::bind(&CPU::WriteCallBack, this, std::placeholders::_1)));
+    }
+}
+
+LockstepTraceCPU::~LockstepTraceCPU() {
+    for (size_t i = 1; i < systems_.size(); i++) {
+        delete systems_[i];
+    }
+    delete trace_reader_;
+}
+
+bool LockstepTraceCPU::FetchTrans(uint64_t trans_num) {
+    while (trans_num >= trace_base_ + trace_.size() && !trace_eof_) {
+        Transaction trans;
+        if (trace_reader_->Next(trans)) {
+            trace_.push_back(trans);
+        } else {
+            trace_eof_ = true;
+        }
+    }
+    return trans_num < trace_base_ + trace_.size();
+}
+
+void LockstepTraceCPU::ClockTick() {
+    // every system runs the same cycle, but takes the transactions at its
+    // own pace as a slower one falls behind
+    for (size_t i = 0; i < systems_.size(); i++) {
+        systems_[i]->ClockTick();
+        if (!FetchTrans(next_trans_[i])) {
+            if (drained_[i] == 0 && systems_[i]->IdleCycles(1) > 0) {
+                drained_[i] = clk_;
+            }
+            continue;
+        }
+        const auto& trans = trace_[next_trans_[i] - trace_base_];
+        if (trans.added_cycle <= clk_ &&
+            systems_[i]->WillAcceptTransaction(trans.addr, trans.is_write,
+                                               trans.is_NEI_ACT)) {
+            systems_[i]->AddTransaction(trans.addr, trans.is_write,
+                                        trans.is_NEI_ACT);
+            next_trans_[i]++;
+        }
+    }
+    uint64_t slowest = *std::min_element(next_trans_.begin(), next_trans_.end());
+    while (trace_base_ < slowest) {
+        trace_.pop_front();
+        trace_base_++;
+    }
+    clk_++;
+    return;
+}
+
+uint64_t LockstepTraceCPU::FastForward(uint64_t limit) {
+    // all systems jump together, as far as the busiest one allows
+    for (size_t i = 0; i < systems_.size(); i++) {
+        if (!FetchTrans(next_trans_[i])) {
+            continue;
+        }
+        uint64_t next = trace_[next_trans_[i] - trace_base_].added_cycle;
+        if (next <= clk_) {
+            return 0;
+        }
+        limit = std::min(limit, next - clk_);
+    }
+    for (auto system : systems_) {
+        limit = system->IdleCycles(limit);
+    }
+    if (limit > 0) {
+        for (auto system : systems_) {
+            system->SkipCycles(limit);
+        }
+        clk_ += limit;
+    }
+    return limit;
+}
+
+void LockstepTraceCPU::PrintStats() {
+    std::vector<double> reqs, latency, energy, nei_acts;
+    for (auto system : systems_) {
+        system->PrintStats();
+        auto summary = GetRunSummary(*system);
+        reqs.push_back(summary.reqs_done);
+        latency.push_back(summary.avg_read_latency);
+        energy.push_back(summary.total_energy);
+        nei_acts.push_back(summary.nei_acts);
+    }
+
+    // slowdown: cycles to drain the trace against those of the baseline,
+    // the trace timestamps pace the requests, so the counts rarely differ
+    // (0 if a system did not drain it within the run)
+    std::cout << "lockstep comparison against " << labels_[0] << std::endl;
+    std::cout << std::left << std::setw(16) << "config" << std::right
+              << std::setw(12) << "trans" << std::setw(12) << "reqs_done"
+              << std::setw(12) << "drained" << std::setw(12) << "slowdown"
+              << std::setw(14)
+              << "avg_read_lat" << std::setw(12) << "lat_delta%"
+              << std::setw(16) << "energy(pJ)" << std::setw(12)
+              << "energy_d%" << std::setw(12) << "NEI_ACT" << std::endl;
+    auto delta = [](double value, double base) {
+        return base > 0 ? (value - base) / base * 100 : 0.0;
+    };
+    std::cout << std::fixed;
+    for (size_t i = 0; i < systems_.size(); i++) {
+        std::cout << std::left << std::setw(16) << labels_[i] << std::right
+                  << std::setw(12) << next_trans_[i] << std::setw(12)
+                  << std::setprecision(0) << reqs[i] << std::setw(12)
+                  << drained_[i] << std::setw(12) << std::setprecision(4)
+                  << (drained_[0] > 0 ? static_cast<double>(drained_[i]) /
+                                            drained_[0]
+                                      : 0.0)
+                  << std::setw(14) << std::setprecision(2) << latency[i]
+                  << std::setw(12) << delta(latency[i], latency[0])
+                  << std::setw(16) << std::setprecision(0) << energy[i]
+                  << std::setw(12) << std::setprecision(2)
+                  << delta(energy[i], energy[0]) << std::setw(12)
+                  << std::setprecision(0) << nei_acts[i] << std::endl;
+    }
+    std::cout.unsetf(std::ios_base::floatfield);
+    std::cout << std::setprecision(6);
+}
+
 }  // namespace dramsim3
@@ -1,14 +1,27 @@
 #ifndef __CPU_H
 #define __CPU_H
 
+#include <deque>
 #include <fstream>
 #include <functional>
 #include <random>
 #include <string>
+#include <vector>
 #include "memory_system.h"
+#include "trace_reader.h"
 
 namespace dramsim3 {
 
+// totals over the channels of a memory system, once its stats are printed
+struct RunSummary {
+    double reqs_done;
+    double avg_read_latency;
+    double total_energy;
+    double nei_acts;
+};
+
+RunSummary GetRunSummary(const MemorySystem& memory_system);
+
 class CPU {
    public:
     CPU(const std::string& config_file, const std::string& output_dir)
@@ -17,14 +30,27 @@ class CPU {
               std::bind(&CPU::ReadCallBack, this, std::placeholders::_1),
               std::bind(&CPU::WriteCallBack, this, std::placeholders::_1)),
           clk_(0) {}
+    CPU(const Config& config, const std::string& output_dir)
+        : memory_system_(
+              config, output_dir,
+              std::bind(&CPU::ReadCallBack, this, std::placeholders::_1),
+              std::bind(&CPU::WriteCallBack, this, std::placeholders::_1)),
+          clk_(0) {}
+    virtual ~CPU() {}
     virtual void ClockTick() = 0;
-    void ReadCallBack(uint64_t addr) { return; }
-    void WriteCallBack(uint64_t addr) { return; }
-    void PrintStats() { memory_system_.PrintStats(); }
+    virtual void ReadCallBack(uint64_t addr) { return; }
+    virtual void WriteCallBack(uint64_t addr) { return; }
+    virtual void PrintStats() { memory_system_.PrintStats(); }
+    RunSummary Summary() const { return GetRunSummary(memory_system_); }
+    // jumps over the cycles, at most limit, before the next request is
+    // due in which the memory system is idle; returns the cycles skipped
+    virtual uint64_t FastForward(uint64_t limit);
 
    protected:
     MemorySystem memory_system_;
     uint64_t clk_;
+    // cycle of the next request, clk_ if one may be issued any cycle
+    virtual uint64_t NextRequestCycle() { return clk_; }
 };
 
 class RandomCPU : public CPU {
@@ -54,17 +80,138 @@ class StreamCPU : public CPU {
     const int stride_ = 64;                // stride in bytes
 };
 
+// row-hammer attack generated on the fly, see [hammer] in the config
+class HammerCPU : public CPU {
+   public:
+    HammerCPU(const Config& config, const std::string& output_dir);
+    void ClockTick() override;
+
+   protected:
+    uint64_t NextRequestCycle() override;
+
+   private:
+    std::vector<uint64_t> aggressors_;  // hammered in turn
+    size_t next_aggressor_ = 0;
+    uint64_t next_hammer_clk_ = 0;
+    uint64_t interval_;
+    std::string benign_;
+    std::bernoulli_distribution benign_dist_;
+    uint64_t benign_addr_;
+    bool benign_write_ = false;
+    bool get_next_benign_ = true;
+    uint64_t stream_addr_;
+    std::mt19937_64 gen;
+    const int stride_ = 64;  // stride in bytes of STREAM benign traffic
+};
+
+// prefetch parses the trace on another thread, see PrefetchTraceReader
+// start_cycle drops the requests before it and simulates the rest as if
+// the trace began there
 class TraceBasedCPU : public CPU {
    public:
     TraceBasedCPU(const std::string& config_file, const std::string& output_dir,
-                  const std::string& trace_file);
-    ~TraceBasedCPU() { trace_file_.close(); }
+                  const std::string& trace_file, bool prefetch = false,
+                  uint64_t start_cycle = 0);
+    TraceBasedCPU(const Config& config, const std::string& output_dir,
+                  const std::string& trace_file, bool prefetch = false,
+                  uint64_t start_cycle = 0);
+    ~TraceBasedCPU() { delete trace_reader_; }
     void ClockTick() override;
 
+   protected:
+    uint64_t NextRequestCycle() override;
+
    private:
-    std::ifstream trace_file_;
+    TraceReader* trace_reader_;
     Transaction trans_;
+    uint64_t start_cycle_;
     bool get_next_ = true;
+    bool trace_done_ = false;
+    void OpenTrace(const std::string& trace_file, bool prefetch);
+    void ReadNext();
+};
+
+// one trace per core, merged by timestamp: every cycle each core whose
+// next request is due offers it, oldest first, and a core whose request
+// is refused stalls without holding back the others; requests carry
+// their core as source, which the completions hand back
+class MultiTraceCPU : public CPU {
+   public:
+    MultiTraceCPU(const Config& config, const std::string& output_dir,
+                  const std::vector<std::string>& trace_files,
+                  bool prefetch = false);
+    ~MultiTraceCPU();
+    void ClockTick() override;
+    void ReadCallBack(uint64_t addr, int core);
+    void WriteCallBack(uint64_t addr, int core);
+    void PrintStats() override;
+
+   protected:
+    uint64_t NextRequestCycle() override;
+
+   private:
+    struct Core {
+        std::string trace_file;
+        TraceReader* trace_reader;
+        Transaction trans;  // next request
+        bool trace_done = false;
+        uint64_t reqs_issued = 0;
+        uint64_t reads_done = 0;
+        uint64_t writes_done = 0;
+        uint64_t read_latency = 0;  // sum over reads_done, in cycles
+        uint64_t stall_cycles = 0;  // due but refused by the memory system
+        // (address, issue cycle) of the reads in flight, oldest first
+        std::deque<std::pair<uint64_t, uint64_t> > pending_reads;
+    };
+    std::vector<Core> cores_;
+    std::string output_prefix_;
+    double tCK_;
+    int request_size_bytes_;
+};
+
+// replays a trace already loaded in memory, shared by several simulations
+class MemoryTraceCPU : public CPU {
+   public:
+    MemoryTraceCPU(const Config& config, const std::string& output_dir,
+                   const std::vector<Transaction>& trace);
+    void ClockTick() override;
+
+   protected:
+    uint64_t NextRequestCycle() override;
+
+   private:
+    const std::vector<Transaction>& trace_;
+    size_t next_trans_ = 0;
+};
+
+// parses a trace once and feeds it to one memory system per config in
+// lockstep, e.g. without and with a rowhammer mitigation; the first one
+// is the baseline of the comparison printed with the stats
+class LockstepTraceCPU : public CPU {
+   public:
+    LockstepTraceCPU(const std::vector<Config>& configs,
+                     const std::vector<std::string>& labels,
+                     const std::string& output_dir,
+                     const std::string& trace_file, bool prefetch = false);
+    ~LockstepTraceCPU();
+    void ClockTick() override;
+    void PrintStats() override;
+    uint64_t FastForward(uint64_t limit) override;
+
+   private:
+    TraceReader* trace_reader_;
+    // transactions not yet accepted by every memory system,
+    // trace_.front() is transaction number trace_base_
+    std::deque<Transaction> trace_;
+    uint64_t trace_base_ = 0;
+    bool trace_eof_ = false;
+    std::vector<MemorySystem*> systems_;  // systems_[0] is memory_system_
+    std::vector<std::string> labels_;
+    std::vector<uint64_t> next_trans_;
+    // first cycle each system was idle with the whole trace accepted,
+    // 0 until then
+    std::vector<uint64_t> drained_;
+    bool FetchTrans(uint64_t trans_num);
 };
 
 }  // namespace dramsim3
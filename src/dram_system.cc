@@ -1,12 +1,13 @@
 #include "dram_system.h"
 
 #include <assert.h>
+#include <algorithm>
 
 namespace dramsim3 {
 
 // alternative way is to assign the id in constructor but this is less
 // destructive
-int BaseDRAMSystem::total_channels_ = 0;
+std::atomic<int> BaseDRAMSystem::total_channels_(0);
 
 BaseDRAMSystem::BaseDRAMSystem(Config &config, const std::string &output_dir,
                                std::function<void(uint64_t)> read_callback,
@@ -79,6 +80,15 @@ void BaseDRAMSystem::PrintStats() {
 #endif  // THERMAL
 }
 
+std::vector<double> BaseDRAMSystem::GetChannelStats(
+    const std::string &name) const {
+    std::vector<double> stats;
+    for (auto ctrl : ctrls_) {
+        stats.push_back(ctrl->GetStat(name));
+    }
+    return stats;
+}
+
 void BaseDRAMSystem::ResetStats() {
     for (size_t i = 0; i < ctrls_.size(); i++) {
         ctrls_[i]->ResetStats();
@@ -93,6 +103,25 @@ void BaseDRAMSystem::RegisterCallbacks(
     write_callback_ = write_callback;
 }
 
+void BaseDRAMSystem::RegisterSourceCallbacks(
+    std::function<void(uint64_t, int)> read_callback,
+    std::function<void(uint64_t, int)> write_callback) {
+    source_read_callback_ = read_callback;
+    source_write_callback_ = write_callback;
+}
+
+void BaseDRAMSystem::ReturnTrans(uint64_t req_id, bool is_write, int source) {
+    auto &source_callback =
+        is_write ? source_write_callback_ : source_read_callback_;
+    if (source >= 0 && source_callback) {
+        source_callback(req_id, source);
+    } else if (is_write) {
+        write_callback_(req_id);
+    } else {
+        read_callback_(req_id);
+    }
+}
+
 JedecDRAMSystem::JedecDRAMSystem(Config &config, const std::string &output_dir,
                                  std::function<void(uint64_t)> read_callback,
                                  std::function<void(uint64_t)> write_callback)
@@ -119,13 +148,15 @@ JedecDRAMSystem::~JedecDRAMSystem() {
     }
 }
 
-bool JedecDRAMSystem::WillAcceptTransaction(uint64_t hex_addr,
-                                            bool is_write) const {
+bool JedecDRAMSystem::WillAcceptTransaction(uint64_t hex_addr, bool is_write,
+                                            bool is_NEI_ACT) const {
     int channel = GetChannel(hex_addr);
-    return ctrls_[channel]->WillAcceptTransaction(hex_addr, is_write);
+    return ctrls_[channel]->WillAcceptTransaction(hex_addr, is_write,
+                                                  is_NEI_ACT);
 }
 
-bool JedecDRAMSystem::AddTransaction(uint64_t hex_addr, bool is_write, bool is_NEI_ACT) {
+bool JedecDRAMSystem::AddTransaction(uint64_t hex_addr, bool is_write,
+                                     bool is_NEI_ACT, int source) {
 // Record trace - Record address trace for debugging or other purposes
 #ifdef ADDR_TRACE
     address_trace_ << std::hex << hex_addr << std::dec << " "
@@ -133,11 +164,13 @@ bool JedecDRAMSystem::AddTransaction(uint64_t hex_addr, bool is_write, bool is_N
 #endif
 
     int channel = GetChannel(hex_addr);
-    bool ok = ctrls_[channel]->WillAcceptTransaction(hex_addr, is_write);
+    bool ok = ctrls_[channel]->WillAcceptTransaction(hex_addr, is_write,
+                                                     is_NEI_ACT);
 
     assert(ok);
     if (ok) {
         Transaction trans = Transaction(hex_addr, is_write, is_NEI_ACT);
+        trans.source = source;
         ctrls_[channel]->AddTransaction(trans);
     }
     last_req_clk_ = clk_;
@@ -149,11 +182,10 @@ void JedecDRAMSystem::ClockTick() {
     for (size_t i = 0; i < ctrls_.size(); i++) {
         // look ahead and return earlier
         while (true) {
-            auto pair = ctrls_[i]->ReturnDoneTrans(clk_);
-            if (pair.second == 1) {
-                write_callback_(pair.first);
-            } else if (pair.second == 0) {
-                read_callback_(pair.first);
+            int source;
+            auto pair = ctrls_[i]->ReturnDoneTrans(clk_, &source);
+            if (pair.second == 1 || pair.second == 0) {
+                ReturnTrans(pair.first, pair.second == 1, source);
             } else {
                 // there is no done transaction
                 break;
@@ -172,6 +204,27 @@ void JedecDRAMSystem::ClockTick() {
     return;
 }
 
+uint64_t JedecDRAMSystem::IdleCycles(uint64_t limit) const {
+    // up to the next epoch, whose stats are printed as usual
+    uint64_t cycles = std::min<uint64_t>(
+        limit, config_.epoch_period - clk_ % config_.epoch_period);
+    for (size_t i = 0; i < ctrls_.size() && cycles > 0; i++) {
+        cycles = std::min(cycles, ctrls_[i]->IdleCycles());
+    }
+    return cycles;
+}
+
+void JedecDRAMSystem::SkipCycles(uint64_t cycles) {
+    for (size_t i = 0; i < ctrls_.size(); i++) {
+        ctrls_[i]->SkipCycles(cycles);
+    }
+    clk_ += cycles;
+
+    if (clk_ % config_.epoch_period == 0) {
+        PrintEpochStats();
+    }
+}
+
 IdealDRAMSystem::IdealDRAMSystem(Config &config, const std::string &output_dir,
                                  std::function<void(uint64_t)> read_callback,
                                  std::function<void(uint64_t)> write_callback)
@@ -180,9 +233,11 @@ IdealDRAMSystem::IdealDRAMSystem(Config &config, const std::string &output_dir,
 
 IdealDRAMSystem::~IdealDRAMSystem() {}
 
-bool IdealDRAMSystem::AddTransaction(uint64_t hex_addr, bool is_write, bool is_NEI_ACT) {
+bool IdealDRAMSystem::AddTransaction(uint64_t hex_addr, bool is_write,
+                                     bool is_NEI_ACT, int source) {
     auto trans = Transaction(hex_addr, is_write, is_NEI_ACT);
     trans.added_cycle = clk_;
+    trans.source = source;
     infinite_buffer_q_.push_back(trans);
     return true;
 }
@@ -191,11 +246,7 @@ void IdealDRAMSystem::ClockTick() {
     for (auto trans_it = infinite_buffer_q_.begin();
          trans_it != infinite_buffer_q_.end();) {
         if (clk_ - trans_it->added_cycle >= static_cast<uint64_t>(latency_)) {
-            if (trans_it->is_write) {
-                write_callback_(trans_it->addr);
-            } else {
-                read_callback_(trans_it->addr);
-            }
+            ReturnTrans(trans_it->addr, trans_it->is_write, trans_it->source);
             trans_it = infinite_buffer_q_.erase(trans_it++);
         }
         if (trans_it != infinite_buffer_q_.end()) {
@@ -1,6 +1,7 @@
 #ifndef __DRAM_SYSTEM_H
 #define __DRAM_SYSTEM_H
 
+#include <atomic>
 #include <fstream>
 #include <string>
 #include <vector>
@@ -24,18 +25,32 @@ class BaseDRAMSystem {
     virtual ~BaseDRAMSystem() {}
     void RegisterCallbacks(std::function<void(uint64_t)> read_callback,
                            std::function<void(uint64_t)> write_callback);
+    // requests added with a source (>= 0) are returned with it through
+    // these callbacks instead
+    void RegisterSourceCallbacks(
+        std::function<void(uint64_t, int)> read_callback,
+        std::function<void(uint64_t, int)> write_callback);
     void PrintEpochStats();
     void PrintStats();
     void ResetStats();
+    // final value of a stat in every channel, after PrintStats
+    std::vector<double> GetChannelStats(const std::string &name) const;
 
-    virtual bool WillAcceptTransaction(uint64_t hex_addr,
-                                       bool is_write) const = 0;
-    virtual bool AddTransaction(uint64_t hex_addr, bool is_write, bool is_NEI_ACT) = 0;
+    virtual bool WillAcceptTransaction(uint64_t hex_addr, bool is_write,
+                                       bool is_NEI_ACT) const = 0;
+    virtual bool AddTransaction(uint64_t hex_addr, bool is_write,
+                                bool is_NEI_ACT, int source) = 0;
     virtual void ClockTick() = 0;
+    // cycles from now, at most limit, that SkipCycles can jump over
+    // because nothing but cycle counting would happen in them
+    virtual uint64_t IdleCycles(uint64_t limit) const { return 0; }
+    virtual void SkipCycles(uint64_t cycles) {}
     int GetChannel(uint64_t hex_addr) const;
 
     std::function<void(uint64_t req_id)> read_callback_, write_callback_;
-    static int total_channels_;
+    std::function<void(uint64_t req_id, int source)> source_read_callback_,
+        source_write_callback_;
+    static std::atomic<int> total_channels_;
 
    protected:
     uint64_t id_;
@@ -52,6 +67,9 @@ class BaseDRAMSystem {
     uint64_t clk_;
     std::vector<Controller*> ctrls_;
 
+    // hands a done request to the callback registered for its source
+    void ReturnTrans(uint64_t req_id, bool is_write, int source);
+
 #ifdef ADDR_TRACE
     std::ofstream address_trace_;
 #endif  // ADDR_TRACE
@@ -64,9 +82,13 @@ class JedecDRAMSystem : public BaseDRAMSystem {
                     std::function<void(uint64_t)> read_callback,
                     std::function<void(uint64_t)> write_callback);
     ~JedecDRAMSystem();
-    bool WillAcceptTransaction(uint64_t hex_addr, bool is_write) const override;
-    bool AddTransaction(uint64_t hex_addr, bool is_write, bool is_NEI_ACT) override;
+    bool WillAcceptTransaction(uint64_t hex_addr, bool is_write,
+                               bool is_NEI_ACT) const override;
+    bool AddTransaction(uint64_t hex_addr, bool is_write, bool is_NEI_ACT,
+                        int source = -1) override;
     void ClockTick() override;
+    uint64_t IdleCycles(uint64_t limit) const override;
+    void SkipCycles(uint64_t cycles) override;
 };
 
 // Model a memorysystem with an infinite bandwidth and a fixed latency (possibly
@@ -78,11 +100,12 @@ class IdealDRAMSystem : public BaseDRAMSystem {
                     std::function<void(uint64_t)> read_callback,
                     std::function<void(uint64_t)> write_callback);
     ~IdealDRAMSystem();
-    bool WillAcceptTransaction(uint64_t hex_addr,
-                               bool is_write) const override {
+    bool WillAcceptTransaction(uint64_t hex_addr, bool is_write,
+                               bool is_NEI_ACT) const override {
         return true;
     };
-    bool AddTransaction(uint64_t hex_addr, bool is_write, bool is_NEI_ACT) override;
+    bool AddTransaction(uint64_t hex_addr, bool is_write, bool is_NEI_ACT,
+                        int source) override;
     void ClockTick() override;
 
    private:
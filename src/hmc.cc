@@ -3,7 +3,7 @@
 namespace dramsim3 {
 
 HMCRequest::HMCRequest(HMCReqType req_type, uint64_t hex_addr, int vault)
-    : type(req_type), mem_operand(hex_addr), vault(vault) {
+    : type(req_type), mem_operand(hex_addr), vault(vault), source(-1) {
     is_write = type >= HMCReqType::WR0 && type <= HMCReqType::P_WR256;
     // given that vaults could be 16 (Gen1) or 32(Gen2), using % 4
     // to partition vaults to quads
@@ -111,7 +111,7 @@ HMCRequest::HMCRequest(HMCReqType req_type, uint64_t hex_addr, int vault)
 
 HMCResponse::HMCResponse(uint64_t id, HMCReqType req_type, int dest_link,
                          int src_quad)
-    : resp_id(id), link(dest_link), quad(src_quad) {
+    : resp_id(id), link(dest_link), quad(src_quad), source(-1) {
     switch (req_type) {
         case HMCReqType::RD0:
             type = HMCRespType::RD_RS;
@@ -327,8 +327,8 @@ inline void HMCMemorySystem::IterateNextLink() {
     return;
 }
 
-bool HMCMemorySystem::WillAcceptTransaction(uint64_t hex_addr,
-                                            bool is_write) const {
+bool HMCMemorySystem::WillAcceptTransaction(uint64_t hex_addr, bool is_write,
+                                            bool is_NEI_ACT) const {
     bool insertable = false;
     for (auto link_queue = link_req_queues_.begin();
          link_queue != link_req_queues_.end(); link_queue++) {
@@ -340,7 +340,8 @@ bool HMCMemorySystem::WillAcceptTransaction(uint64_t hex_addr,
     return insertable;
 }
 
-bool HMCMemorySystem::AddTransaction(uint64_t hex_addr, bool is_write, bool is_NEI_ACT) {
+bool HMCMemorySystem::AddTransaction(uint64_t hex_addr, bool is_write,
+                                     bool is_NEI_ACT, int source) {
     // to be compatible with other protocol we have this interface
     // when using this intreface the size of each transaction will be block_size
     HMCReqType req_type;
@@ -391,6 +392,7 @@ bool HMCMemorySystem::AddTransaction(uint64_t hex_addr, bool is_write, bool is_N
     }
     int vault = GetChannel(hex_addr);
     HMCRequest *req = new HMCRequest(req_type, hex_addr, vault);
+    req->source = source;
     return InsertHMCReq(req);
 }
 
@@ -405,6 +407,7 @@ bool HMCMemorySystem::InsertReqToLink(HMCRequest *req, int link) {
         link_req_queues_[link].push_back(req);
         HMCResponse *resp =
             new HMCResponse(req->mem_operand, req->type, link, req->quad);
+        resp->source = req->source;
         resp_lookup_table_.insert(
             std::pair<uint64_t, HMCResponse *>(resp->resp_id, resp));
         link_age_counter_[link] = 1;
@@ -448,8 +451,8 @@ void HMCMemorySystem::DrainRequests() {
             quad_resp_queues_[i].size() < queue_depth_) {
             HMCRequest *req = quad_req_queues_[i].front();
             if (req->exit_time <= logic_clk_) {
-                if (ctrls_[req->vault]->WillAcceptTransaction(req->mem_operand,
-                                                              req->is_write)) {
+                if (ctrls_[req->vault]->WillAcceptTransaction(
+                        req->mem_operand, req->is_write, false)) {
                     InsertReqToDRAM(req);
                     delete (req);
                     quad_req_queues_[i].erase(quad_req_queues_[i].begin());
@@ -497,11 +500,8 @@ void HMCMemorySystem::DrainResponses() {
         if (!link_resp_queues_[i].empty()) {
             HMCResponse *resp = link_resp_queues_[i].front();
             if (resp->exit_time <= logic_clk_) {
-                if (resp->type == HMCRespType::RD_RS) {
-                    read_callback_(resp->resp_id);
-                } else {
-                    write_callback_(resp->resp_id);
-                }
+                ReturnTrans(resp->resp_id, resp->type != HMCRespType::RD_RS,
+                            resp->source);
                 delete (resp);
                 link_resp_queues_[i].erase(link_resp_queues_[i].begin());
             }
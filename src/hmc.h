@@ -86,6 +86,7 @@ class HMCRequest {
     int vault;
     int flits;
     bool is_write;
+    int source;
     // this exit_time is the time to exit xbar to vaults
     uint64_t exit_time;
 };
@@ -98,6 +99,7 @@ class HMCResponse {
     int link;
     int quad;
     int flits;
+    int source;
     // this exit_time is the time to exit xbar to cpu
     uint64_t exit_time;
 };
@@ -114,8 +116,10 @@ class HMCMemorySystem : public BaseDRAMSystem {
     void ClockTick() override;
 
     // had to have 3 insert interfaces cuz HMC is so different...
-    bool WillAcceptTransaction(uint64_t hex_addr, bool is_write) const override;
-    bool AddTransaction(uint64_t hex_addr, bool is_write, bool is_NEI_ACT=false) override;
+    bool WillAcceptTransaction(uint64_t hex_addr, bool is_write,
+                               bool is_NEI_ACT = false) const override;
+    bool AddTransaction(uint64_t hex_addr, bool is_write, bool is_NEI_ACT=false,
+                        int source=-1) override;
     bool InsertReqToLink(HMCRequest* req, int link);
     bool InsertHMCReq(HMCRequest* req);
 
@@ -0,0 +1,145 @@
+#include "hot_row_profiler.h"
+
+#include <algorithm>
+
+namespace dramsim3 {
+
+namespace {
+bool HotterThan(const std::pair<int, uint32_t>& a,
+                const std::pair<int, uint32_t>& b) {
+    return a.second > b.second;
+}
+}  // namespace
+
+HotRowProfiler::HotRowProfiler(const Config& config)
+    : config_(config),
+      top_k_(config.hot_rows),
+      width_(config.hot_rows_sketch_width),
+      depth_(config.hot_rows_sketch_depth),
+      sketch_(top_k_ > 0 ? static_cast<size_t>(config.ranks) * config.banks *
+                               depth_ * width_
+                         : 0,
+              0),
+      top_(top_k_ > 0 ? config.ranks * config.banks : 0) {}
+
+int HotRowProfiler::BankIndex(const Address& addr) const {
+    return (addr.rank * config_.bankgroups + addr.bankgroup) *
+               config_.banks_per_group +
+           addr.bank;
+}
+
+uint32_t HotRowProfiler::UpdateSketch(int bank, int row) {
+    // conservative update: only the smallest counters grow, which keeps
+    // the overestimation of cold rows colliding with hot ones low
+    uint32_t* counters = &sketch_[static_cast<size_t>(bank) * depth_ * width_];
+    uint64_t h1 = (static_cast<uint64_t>(row) + 1) * 0x9E3779B97F4A7C15ull;
+    uint64_t h2 = (h1 ^ (h1 >> 29)) * 0xBF58476D1CE4E5B9ull;
+    auto cell = [&](int d) -> uint32_t& {
+        uint64_t h = (h1 >> 32) + d * ((h2 >> 32) | 1);
+        return counters[d * width_ + h % width_];
+    };
+    uint32_t estimate = UINT32_MAX;
+    for (int d = 0; d < depth_; d++) {
+        estimate = std::min(estimate, cell(d));
+    }
+    if (estimate < UINT32_MAX) estimate++;
+    for (int d = 0; d < depth_; d++) {
+        cell(d) = std::max(cell(d), estimate);
+    }
+    return estimate;
+}
+
+void HotRowProfiler::Place(TopRows& top, int i, const HotRow& hot) {
+    top.heap[i] = hot;
+    top.index[hot.row] = i;
+}
+
+void HotRowProfiler::SiftUp(TopRows& top, int i) {
+    HotRow hot = top.heap[i];
+    while (i > 0 && top.heap[(i - 1) / 2].count > hot.count) {
+        Place(top, i, top.heap[(i - 1) / 2]);
+        i = (i - 1) / 2;
+    }
+    Place(top, i, hot);
+}
+
+void HotRowProfiler::SiftDown(TopRows& top, int i) {
+    HotRow hot = top.heap[i];
+    int size = static_cast<int>(top.heap.size());
+    while (2 * i + 1 < size) {
+        int child = 2 * i + 1;
+        if (child + 1 < size &&
+            top.heap[child + 1].count < top.heap[child].count) {
+            child++;
+        }
+        if (top.heap[child].count >= hot.count) {
+            break;
+        }
+        Place(top, i, top.heap[child]);
+        i = child;
+    }
+    Place(top, i, hot);
+}
+
+void HotRowProfiler::AddActivation(const Address& addr) {
+    if (top_k_ <= 0) {
+        return;
+    }
+    int bank = BankIndex(addr);
+    uint32_t count = UpdateSketch(bank, addr.row);
+    auto& top = top_[bank];
+    auto it = top.index.find(addr.row);
+    if (it != top.index.end()) {
+        // estimates only grow, the row can only move down
+        top.heap[it->second].count = count;
+        SiftDown(top, it->second);
+    } else if (static_cast<int>(top.heap.size()) < top_k_) {
+        top.heap.push_back(HotRow{addr.row, count});
+        SiftUp(top, static_cast<int>(top.heap.size()) - 1);
+    } else if (count > top.heap.front().count) {
+        // replaces the coldest of the top rows
+        top.index.erase(top.heap.front().row);
+        top.heap.front() = HotRow{addr.row, count};
+        SiftDown(top, 0);
+    }
+}
+
+nlohmann::json HotRowProfiler::ToJson() const {
+    nlohmann::json banks = nlohmann::json::object();
+    if (top_.empty()) {
+        return banks;
+    }
+    for (int r = 0; r < config_.ranks; r++) {
+        for (int bg = 0; bg < config_.bankgroups; bg++) {
+            for (int ba = 0; ba < config_.banks_per_group; ba++) {
+                Address addr(-1, r, bg, ba, -1, -1);
+                const auto& heap = top_[BankIndex(addr)].heap;
+                if (heap.empty()) {
+                    continue;
+                }
+                std::vector<std::pair<int, uint32_t> > rows;
+                for (const auto& hot : heap) {
+                    rows.emplace_back(hot.row, hot.count);
+                }
+                std::sort(rows.begin(), rows.end(), HotterThan);
+                nlohmann::json j_rows = nlohmann::json::array();
+                for (const auto& row : rows) {
+                    j_rows.push_back({row.first, row.second});
+                }
+                banks[std::to_string(r) + "." + std::to_string(bg) + "." +
+                      std::to_string(ba)] = j_rows;
+            }
+        }
+    }
+    return banks;
+}
+
+void HotRowProfiler::Reset() {
+    std::fill(sketch_.begin(), sketch_.end(), 0);
+    for (auto& top : top_) {
+        top.heap.clear();
+        top.index.clear();
+    }
+}
+
+}  // namespace dramsim3
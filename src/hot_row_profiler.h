@@ -0,0 +1,49 @@
+#ifndef __HOT_ROW_PROFILER_H
+#define __HOT_ROW_PROFILER_H
+
+#include <unordered_map>
+#include <vector>
+#include "common.h"
+#include "configuration.h"
+#include "json.hpp"
+
+namespace dramsim3 {
+
+// most activated rows of every bank in fixed memory: a count-min sketch
+// estimates the activations of a row (never below the actual count) and
+// a min-heap keeps the top K estimates; nothing is kept for K = 0
+class HotRowProfiler {
+   public:
+    HotRowProfiler(const Config& config);
+    void AddActivation(const Address& addr);
+    // {"rank.bankgroup.bank": [[row, activations], ...]}, hottest first
+    nlohmann::json ToJson() const;
+    void Reset();
+
+   private:
+    struct HotRow {
+        int row;
+        uint32_t count;
+    };
+    // min-heap by count and the position of every row in it, so a row
+    // whose estimate grew is sifted down from where it is
+    struct TopRows {
+        std::vector<HotRow> heap;
+        std::unordered_map<int, int> index;
+    };
+    const Config& config_;
+    const int top_k_;
+    const int width_;
+    const int depth_;
+    std::vector<uint32_t> sketch_;  // [bank][depth][width]
+    std::vector<TopRows> top_;      // [bank]
+
+    int BankIndex(const Address& addr) const;
+    uint32_t UpdateSketch(int bank, int row);
+    void Place(TopRows& top, int i, const HotRow& hot);
+    void SiftUp(TopRows& top, int i);
+    void SiftDown(TopRows& top, int i);
+};
+
+}  // namespace dramsim3
+#endif
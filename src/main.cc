@@ -1,15 +1,24 @@
+#include <algorithm>
 #include <iostream>
+#include <thread>
 #include "./../ext/headers/args.hxx"
 #include "cpu.h"
 #include "rowhammer.h"
+#include "sweep.h"
 
 using namespace dramsim3;
 
+static bool IsRowhammerScheme(const std::string &scheme) {
+    return scheme == "X" || scheme == "PRA" || scheme == "CRA" ||
+           scheme == "Graphene" || scheme == "BlockHammer" || scheme == "RRS";
+}
+
 int main(int argc, const char **argv) {
     args::ArgumentParser parser(
         "DRAM Simulator.",
         "Examples: \n"
         "dramsim3main ../configs/DDR4_4Gb_x8_2400.ini -c 100000 -t ../trace_DDR4_4Gb_x8_2400 -r CRA\n"
+        "rowhammer options can also be given in the [rowhammer] section of the config file\n"
         );
     args::HelpFlag help(parser, "help", "Display the help menu", {'h', "help"});
     args::ValueFlag<uint64_t> num_cycles_arg(parser, "num_cycles",
@@ -19,22 +28,109 @@ int main(int argc, const char **argv) {
         parser, "output_dir", "Output directory for stats files",
         {'o', "output-dir"}, ".");
     args::ValueFlag<std::string> stream_arg(
-        parser, "stream_type", "address stream generator - (random), stream",
+        parser, "stream_type", "address stream generator - (random), stream, hammer",
         {'s', "stream"}, "");
     args::ValueFlag<std::string> trace_file_arg(
         parser, "trace",
-        "Trace file, setting this option will ignore -s option",
+        "Trace file, setting this option will ignore -s option; a comma separated list simulates one trace per core",
         {'t', "trace"});
     args::ValueFlag<std::string> rowhammer_arg(
         parser, "rowhammer",
-        "Rowhammer protection, option: X (not applied, default), PRA (Probablistic Row Activation), CRA (Counter-based Row Activation)",
+        "Rowhammer protection, option: X (not applied, default), PRA (Probablistic Row Activation), CRA (Counter-based Row Activation), Graphene (Misra-Gries tracker), BlockHammer (ACT throttling), RRS (Randomized Row-Swap)",
         {'r', "rowhammer"}, "X");
     args::ValueFlag<float> probability(
         parser, "probability for PRA (default: 0.001, max=1)", "this option will be ignore on -r CRA",
         {'p', "probability"}, 0.01);
     args::ValueFlag<int> threshold(
-        parser, "threshold for CRA (default: 25)", "this option will be ignore on -r PRA",
+        parser, "threshold for CRA, Graphene and RRS (default: 25)", "this option will be ignore on -r PRA",
         {"thd"}, 25);
+    args::ValueFlag<int> seed_arg(
+        parser, "seed",
+        "Seed of the PRA and TRR random streams, one per bank (default: 0)",
+        {"seed"}, 0);
+    args::ValueFlag<int> convert_threads_arg(
+        parser, "convert_threads",
+        "Number of threads parsing the trace with --convert-trace (default: 1)",
+        {"convert-threads"}, 1);
+    args::ValueFlag<std::string> cra_tracker_arg(
+        parser, "cra_tracker",
+        "CRA counter storage - (dense) counter for every row, sparse hash of activated rows",
+        {"cra-tracker"}, "dense");
+    args::ValueFlag<int> trr_entries_arg(
+        parser, "trr_entries",
+        "In-DRAM TRR sampler entries per bank, runs along with -r (default: 0, disabled)",
+        {"trr-entries"}, 0);
+    args::ValueFlag<std::string> trr_policy_arg(
+        parser, "trr_policy",
+        "TRR sampler policy - COUNTER (most activated rows) or SAMPLE (most recent sampled rows)",
+        {"trr-policy"}, "COUNTER");
+    args::Flag rfm_arg(
+        parser, "rfm",
+        "DDR5 refresh management (RFM) at raaimt activations per bank, along with -r",
+        {"rfm"});
+    args::ValueFlag<std::string> hammer_pattern_arg(
+        parser, "hammer_pattern",
+        "Attack of -s hammer - SINGLE, (DOUBLE) or MANY sided",
+        {"hammer-pattern"}, "DOUBLE");
+    args::ValueFlag<int> hammer_aggressors_arg(
+        parser, "hammer_aggressors",
+        "Aggressor rows of -s hammer --hammer-pattern MANY (default: 8)",
+        {"hammer-aggressors"}, 8);
+    args::ValueFlag<int> hammer_interval_arg(
+        parser, "hammer_interval",
+        "Cycles between the aggressor accesses of -s hammer (default: 0, tRC)",
+        {"hammer-interval"}, 0);
+    args::ValueFlag<std::string> hammer_benign_arg(
+        parser, "hammer_benign",
+        "Benign traffic in between the aggressor accesses of -s hammer - (NONE), RANDOM, STREAM",
+        {"hammer-benign"}, "NONE");
+    args::ValueFlag<std::string> compare_arg(
+        parser, "compare",
+        "Feed the trace to one memory system per scheme in lockstep, the first one is the baseline, "
+        "e.g. X,PRA:0.001,CRA:50 (value: probability for PRA, threshold for CRA, Graphene and RRS)",
+        {"compare"});
+    args::ValueFlag<std::string> sweep_p_arg(
+        parser, "sweep_p",
+        "Simulate the trace with PRA for every probability of start:end:num on --sweep-threads",
+        {"sweep-p"});
+    args::ValueFlag<std::string> sweep_thd_arg(
+        parser, "sweep_thd",
+        "Simulate the trace with -r CRA (default), Graphene or RRS for every threshold of start:end:num",
+        {"sweep-thd"});
+    args::ValueFlag<int> sweep_threads_arg(
+        parser, "sweep_threads",
+        "Number of simulations run at the same time by a sweep (default: number of cores)",
+        {"sweep-threads"}, 0);
+    args::Flag convert_trace_arg(
+        parser, "convert_trace",
+        "Apply the rowhammer protection by writing a *_applied trace file before simulating, "
+        "instead of inside the memory controller",
+        {"convert-trace"});
+    args::Flag fast_forward_arg(
+        parser, "fast_forward",
+        "Skip the cycles in which the memory system is idle and no request is due, "
+        "with the same stats",
+        {"fast-forward"});
+    args::Flag prefetch_trace_arg(
+        parser, "prefetch_trace",
+        "Parse the trace ahead of the simulation on another thread",
+        {"prefetch-trace"});
+    args::ValueFlag<std::string> binary_trace_arg(
+        parser, "binary_trace",
+        "Write the trace given with -t as a binary trace to this file and exit",
+        {"write-binary-trace"});
+    args::ValueFlag<std::string> compressed_trace_arg(
+        parser, "compressed_trace",
+        "Write the trace given with -t as a compressed trace to this file and exit",
+        {"write-compressed-trace"});
+    args::ValueFlag<uint64_t> trace_start_arg(
+        parser, "trace_start_cycle",
+        "Start the simulation at this cycle of a single trace, dropping the requests before it",
+        {"trace-start-cycle"}, 0);
+    args::ValueFlag<std::string> convert_format_arg(
+        parser, "convert_format",
+        "Format of the trace written by --convert-trace: text, binary or compressed (default: text)",
+        {"convert-format"}, "text");
     args::Positional<std::string> config_arg(
         parser, "config", "The config file name (mandatory)");
 
@@ -61,41 +157,174 @@ int main(int argc, const char **argv) {
     std::string stream_type = args::get(stream_arg);
     std::string rowhammer_type = args::get(rowhammer_arg);
 
-    CPU *cpu;
-    if (!trace_file.empty()) {
-        bool is_cra = true;
-        if (rowhammer_type.compare("PRA") == 0) {
-            // probability = 0.001
-            PRA pra(config_file,output_dir,trace_file, args::get(probability));
-            is_cra = false;
-            trace_file = pra.convertedTrace(is_cra);
+    // one trace per core
+    std::vector<std::string> core_traces = StringSplit(trace_file, ',');
+    if (core_traces.size() > 1 &&
+        (binary_trace_arg || compressed_trace_arg || convert_trace_arg ||
+         compare_arg || sweep_p_arg || sweep_thd_arg)) {
+        std::cout << "Multiple traces cannot be written, converted, compared "
+                  << "or swept" << std::endl;
+        return 1;
+    }
+
+    if (trace_start_arg &&
+        (trace_file.empty() || core_traces.size() > 1 || convert_trace_arg ||
+         compare_arg || sweep_p_arg || sweep_thd_arg)) {
+        std::cout << "--trace-start-cycle needs a single trace and no "
+                  << "--convert-trace, --compare or sweep" << std::endl;
+        return 1;
+    }
+
+    if (binary_trace_arg || compressed_trace_arg) {
+        if (trace_file.empty()) {
+            std::cout << "Writing a trace needs a trace file" << std::endl;
+            return 1;
         }
-        else if (rowhammer_type.compare("CRA") == 0) {
-            // threshold = 55555
-            // bit flip occur when consecutive 55555 attacks
-            CRA cra(config_file,output_dir,trace_file, args::get(threshold));
-            trace_file = cra.convertedTrace(is_cra);
+        std::string new_trace_file = binary_trace_arg
+                                         ? args::get(binary_trace_arg)
+                                         : args::get(compressed_trace_arg);
+        uint64_t num_trans =
+            ConvertTrace(trace_file, new_trace_file,
+                         binary_trace_arg ? "binary" : "compressed");
+        std::cout << num_trans << " requests written to " << new_trace_file
+                  << std::endl;
+        return 0;
+    }
+
+    Config config(config_file, output_dir);
+    if (rowhammer_arg) config.rowhammer_scheme = rowhammer_type;
+    if (probability) config.pra_probability = args::get(probability);
+    if (seed_arg) config.rowhammer_seed = args::get(seed_arg);
+    if (threshold) config.cra_threshold = args::get(threshold);
+    if (cra_tracker_arg) config.cra_tracker = args::get(cra_tracker_arg);
+    if (trr_entries_arg) config.trr_entries = args::get(trr_entries_arg);
+    if (rfm_arg) config.rfm = true;
+    if (trr_policy_arg) config.trr_policy = args::get(trr_policy_arg);
+    if (hammer_pattern_arg) config.hammer_pattern = args::get(hammer_pattern_arg);
+    if (hammer_aggressors_arg) {
+        config.hammer_aggressors = args::get(hammer_aggressors_arg);
+    }
+    if (hammer_interval_arg) {
+        config.hammer_interval = args::get(hammer_interval_arg);
+    }
+    if (hammer_benign_arg) config.hammer_benign = args::get(hammer_benign_arg);
+    if (!IsRowhammerScheme(config.rowhammer_scheme)) {
+        std::cout << "Undefined Row Hammering Scheme" << std::endl;
+        return 0;
+    }
+    if (args::get(convert_trace_arg) &&
+        (config.rowhammer_scheme == "BlockHammer" ||
+         config.rowhammer_scheme == "RRS")) {
+        // throttling and remapping act in the controller, nothing to insert
+        std::cout << config.rowhammer_scheme
+                  << " cannot be applied with --convert-trace" << std::endl;
+        return 0;
+    }
+
+    if (sweep_p_arg || sweep_thd_arg) {
+        if (trace_file.empty() || args::get(convert_trace_arg) ||
+            compare_arg) {
+            std::cout << "A sweep needs a trace file, and no --convert-trace "
+                      << "or --compare" << std::endl;
+            return 0;
+        }
+        std::vector<SweepPoint> points;
+        if (sweep_p_arg) {
+            for (double p : SweepRange(args::get(sweep_p_arg))) {
+                points.push_back({"PRA", p});
+            }
+        }
+        if (sweep_thd_arg) {
+            std::string scheme = config.rowhammer_scheme == "Graphene" ||
+                                         config.rowhammer_scheme == "RRS"
+                                     ? config.rowhammer_scheme
+                                     : "CRA";
+            for (double thd : SweepRange(args::get(sweep_thd_arg))) {
+                points.push_back({scheme, thd});
+            }
+        }
+        int num_threads = args::get(sweep_threads_arg);
+        if (num_threads <= 0) {
+            num_threads = std::max(1u, std::thread::hardware_concurrency());
+        }
+        RunSweep(config, points, output_dir, trace_file, cycles, num_threads,
+                 args::get(fast_forward_arg));
+        return 0;
+    }
+
+    CPU *cpu;
+    if (compare_arg) {
+        if (trace_file.empty() || args::get(convert_trace_arg)) {
+            std::cout << "--compare needs a trace file and no --convert-trace"
+                      << std::endl;
+            return 0;
         }
-        else {
-            if (rowhammer_type.compare("X") != 0){
-                std::cout << "Undefined Row Hammering Scheme" << std::endl;
+        std::vector<Config> configs;
+        std::vector<std::string> labels;
+        for (const auto &scheme : StringSplit(args::get(compare_arg), ',')) {
+            auto tokens = StringSplit(scheme, ':');
+            Config lane_config(config);
+            lane_config.rowhammer_scheme = tokens[0];
+            if (!IsRowhammerScheme(tokens[0]) || tokens.size() > 2 ||
+                (tokens.size() == 2 && tokens[0] != "PRA" &&
+                 tokens[0] != "CRA" && tokens[0] != "Graphene" &&
+                 tokens[0] != "RRS")) {
+                std::cout << "Undefined Row Hammering Scheme " << scheme
+                          << std::endl;
                 return 0;
             }
+            std::string label = tokens[0];
+            if (tokens.size() == 2) {
+                if (tokens[0] == "PRA") {
+                    lane_config.pra_probability = std::stod(tokens[1]);
+                } else {
+                    lane_config.cra_threshold = std::stoi(tokens[1]);
+                }
+                label += "_" + tokens[1];
+            }
+            lane_config.SetOutputSuffix(label);
+            configs.push_back(lane_config);
+            labels.push_back(label);
         }
-        cpu = new TraceBasedCPU(config_file, output_dir, trace_file);
+        cpu = new LockstepTraceCPU(configs, labels, output_dir, trace_file,
+                                   args::get(prefetch_trace_arg));
+    } else if (core_traces.size() > 1) {
+        cpu = new MultiTraceCPU(config, output_dir, core_traces,
+                                args::get(prefetch_trace_arg));
+    } else if (!trace_file.empty()) {
+        if (args::get(convert_trace_arg) && config.rowhammer_scheme != "X") {
+            // e.g. threshold = 55555 for CRA,
+            // bit flip occur when consecutive 55555 attacks
+            trace_file = Rowhammer::convertedTrace(
+                config, trace_file, args::get(convert_threads_arg),
+                args::get(convert_format_arg));
+            // already applied to the trace, not again in the controller
+            config.rowhammer_scheme = "X";
+        }
+        cpu = new TraceBasedCPU(config, output_dir, trace_file,
+                                args::get(prefetch_trace_arg),
+                                args::get(trace_start_arg));
     } else {
         if (stream_type == "stream" || stream_type == "s") {
-            cpu = new StreamCPU(config_file, output_dir);
+            cpu = new StreamCPU(config, output_dir);
+        } else if (stream_type == "hammer" || stream_type == "h") {
+            cpu = new HammerCPU(config, output_dir);
         } else {
-            cpu = new RandomCPU(config_file, output_dir);
+            cpu = new RandomCPU(config, output_dir);
         }
     }
     std::cout << "simulating trace file ";
-    const uint64_t denominator = cycles / 10;
+    const uint64_t denominator = std::max<uint64_t>(cycles / 10, 1);
+    uint64_t next_progress = 0;
     for (uint64_t clk = 0; clk < cycles; clk++) {
-        if (clk % denominator==0) std::cout<< "-"<<std::flush;
+        if (args::get(fast_forward_arg)) {
+            // the last cycle is always ticked
+            clk += cpu->FastForward(cycles - clk - 1);
+        }
+        for (; next_progress <= clk; next_progress += denominator) {
+            std::cout << "-" << std::flush;
+        }
         cpu->ClockTick();
-
     }
     std::cout << " done" << std::endl;
     cpu->PrintStats();
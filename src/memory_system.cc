@@ -6,6 +6,21 @@ MemorySystem::MemorySystem(const std::string &config_file,
                            std::function<void(uint64_t)> read_callback,
                            std::function<void(uint64_t)> write_callback)
     : config_(new Config(config_file, output_dir)) {
+    InitDRAMSystem(output_dir, read_callback, write_callback);
+}
+
+// for callers that have already parsed (and possibly tuned) the config,
+// e.g. to apply rowhammer options from the command line
+MemorySystem::MemorySystem(const Config &config, const std::string &output_dir,
+                           std::function<void(uint64_t)> read_callback,
+                           std::function<void(uint64_t)> write_callback)
+    : config_(new Config(config)) {
+    InitDRAMSystem(output_dir, read_callback, write_callback);
+}
+
+void MemorySystem::InitDRAMSystem(
+    const std::string &output_dir, std::function<void(uint64_t)> read_callback,
+    std::function<void(uint64_t)> write_callback) {
     // TODO: ideal memory type?
     if (config_->IsHMC()) {
         dram_system_ = new HMCMemorySystem(*config_, output_dir, read_callback,
@@ -23,6 +38,14 @@ MemorySystem::~MemorySystem() {
 
 void MemorySystem::ClockTick() { dram_system_->ClockTick(); }
 
+uint64_t MemorySystem::IdleCycles(uint64_t limit) const {
+    return dram_system_->IdleCycles(limit);
+}
+
+void MemorySystem::SkipCycles(uint64_t cycles) {
+    dram_system_->SkipCycles(cycles);
+}
+
 double MemorySystem::GetTCK() const { return config_->tCK; }
 
 int MemorySystem::GetBusBits() const { return config_->bus_width; }
@@ -37,22 +60,43 @@ void MemorySystem::RegisterCallbacks(
     dram_system_->RegisterCallbacks(read_callback, write_callback);
 }
 
+void MemorySystem::RegisterSourceCallbacks(
+    std::function<void(uint64_t, int)> read_callback,
+    std::function<void(uint64_t, int)> write_callback) {
+    dram_system_->RegisterSourceCallbacks(read_callback, write_callback);
+}
+
 bool MemorySystem::WillAcceptTransaction(uint64_t hex_addr,
                                          bool is_write) const {
-    return dram_system_->WillAcceptTransaction(hex_addr, is_write);
+    return dram_system_->WillAcceptTransaction(hex_addr, is_write, false);
+}
+bool MemorySystem::WillAcceptTransaction(uint64_t hex_addr, bool is_write,
+                                         bool is_NEI_ACT) const {
+    return dram_system_->WillAcceptTransaction(hex_addr, is_write,
+                                               is_NEI_ACT);
 }
 
 bool MemorySystem::AddTransaction(uint64_t hex_addr, bool is_write) {
-    return dram_system_->AddTransaction(hex_addr, is_write, false);
+    return dram_system_->AddTransaction(hex_addr, is_write, false, -1);
 }
 bool MemorySystem::AddTransaction(uint64_t hex_addr, bool is_write, bool is_NEI_ACT) {
-    return dram_system_->AddTransaction(hex_addr, is_write, is_NEI_ACT);
+    return dram_system_->AddTransaction(hex_addr, is_write, is_NEI_ACT, -1);
+}
+bool MemorySystem::AddTransaction(uint64_t hex_addr, bool is_write,
+                                  bool is_NEI_ACT, int source) {
+    return dram_system_->AddTransaction(hex_addr, is_write, is_NEI_ACT,
+                                        source);
 }
 
 void MemorySystem::PrintStats() const { dram_system_->PrintStats(); }
 
 void MemorySystem::ResetStats() { dram_system_->ResetStats(); }
 
+std::vector<double> MemorySystem::GetChannelStats(
+    const std::string &name) const {
+    return dram_system_->GetChannelStats(name);
+}
+
 MemorySystem* GetMemorySystem(const std::string &config_file, const std::string &output_dir,
                  std::function<void(uint64_t)> read_callback,
                  std::function<void(uint64_t)> write_callback) {
@@ -16,20 +16,36 @@ class MemorySystem {
     MemorySystem(const std::string &config_file, const std::string &output_dir,
                  std::function<void(uint64_t)> read_callback,
                  std::function<void(uint64_t)> write_callback);
+    MemorySystem(const Config &config, const std::string &output_dir,
+                 std::function<void(uint64_t)> read_callback,
+                 std::function<void(uint64_t)> write_callback);
     ~MemorySystem();
     void ClockTick();
+    // idle cycles from now, at most limit, and jumping over them
+    uint64_t IdleCycles(uint64_t limit) const;
+    void SkipCycles(uint64_t cycles);
     void RegisterCallbacks(std::function<void(uint64_t)> read_callback,
                            std::function<void(uint64_t)> write_callback);
+    // requests added with a source (>= 0) are returned with it through
+    // these callbacks instead
+    void RegisterSourceCallbacks(
+        std::function<void(uint64_t, int)> read_callback,
+        std::function<void(uint64_t, int)> write_callback);
     double GetTCK() const;
     int GetBusBits() const;
     int GetBurstLength() const;
     int GetQueueSize() const;
     void PrintStats() const;
     void ResetStats();
+    std::vector<double> GetChannelStats(const std::string &name) const;
 
     bool WillAcceptTransaction(uint64_t hex_addr, bool is_write) const;
+    bool WillAcceptTransaction(uint64_t hex_addr, bool is_write,
+                               bool is_NEI_ACT) const;
     bool AddTransaction(uint64_t hex_addr, bool is_write);
     bool AddTransaction(uint64_t hex_addr, bool is_write, bool is_NEI_ACT);
+    bool AddTransaction(uint64_t hex_addr, bool is_write, bool is_NEI_ACT,
+                        int source);
 
    private:
     // These have to be pointers because Gem5 will try to push this object
@@ -37,6 +53,10 @@ class MemorySystem {
     // here is safe
     Config *config_;
     BaseDRAMSystem *dram_system_;
+
+    void InitDRAMSystem(const std::string &output_dir,
+                        std::function<void(uint64_t)> read_callback,
+                        std::function<void(uint64_t)> write_callback);
 };
 
 MemorySystem* GetMemorySystem(const std::string &config_file, const std::string &output_dir,
@@ -26,6 +26,13 @@ void Refresh::ClockTick() {
     return;
 }
 
+uint64_t Refresh::CyclesToRefresh() const {
+    if (clk_ % refresh_interval_ == 0 && clk_ > 0) {
+        return 0;
+    }
+    return refresh_interval_ - clk_ % refresh_interval_;
+}
+
 void Refresh::InsertRefresh() {
     switch (refresh_policy_) {
         // Simultaneous all rank refresh
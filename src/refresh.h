@@ -12,6 +12,10 @@ class Refresh {
    public:
     Refresh(const Config& config, ChannelState& channel_state);
     void ClockTick();
+    // cycles until a refresh is due, 0 if it is due in this cycle
+    uint64_t CyclesToRefresh() const;
+    // advances over cycles in which no refresh is due
+    void SkipCycles(uint64_t cycles) { clk_ += cycles; }
 
    private:
     uint64_t clk_;
@@ -1,5 +1,11 @@
 #include "rowhammer.h"
-#include <queue>
+#include "trace_reader.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <thread>
+#include <unordered_set>
 namespace dramsim3{
 
 void print_addr(Address addr) {
@@ -10,129 +16,617 @@ void print_addr(Address addr) {
               << "row: " << addr.row << std::endl;
 }
 
-Rowhammer::Rowhammer(std::string config_file, std::string output_file, std::string trace_file, std::string method)
-    : config(config_file, output_file),
-      trace(trace_file),
-      new_trace(trace_file+"_"+method+"_applied")
-    {
-        new_trace_file = trace_file + "_"+method+"_applied";
+RowCounterTable::RowCounterTable(uint64_t size, uint32_t max_count)
+    : max_count(max_count) {
+    if (max_count <= UINT8_MAX) {
+        width = 8;
+        table8.assign(size, 0);
+    } else if (max_count <= UINT16_MAX) {
+        width = 16;
+        table16.assign(size, 0);
+    } else {
+        width = 32;
+        table32.assign(size, 0);
     }
+}
 
-Rowhammer::~Rowhammer() {
-    trace.close();
-    new_trace.close();
+uint32_t RowCounterTable::get(uint64_t row_id) const {
+    switch (width) {
+        case 8:
+            return table8[row_id];
+        case 16:
+            return table16[row_id];
+        default:
+            return table32[row_id];
+    }
 }
 
-std::string Rowhammer::convertedTrace(bool is_cra) {
-    std::cout << "generating new trace file ";
-    std::string str_addr, trans_type; 
+void RowCounterTable::set(uint64_t row_id, uint32_t count) {
+    count = std::min(count, max_count);
+    switch (width) {
+        case 8:
+            table8[row_id] = static_cast<uint8_t>(count);
+            break;
+        case 16:
+            table16[row_id] = static_cast<uint16_t>(count);
+            break;
+        default:
+            table32[row_id] = count;
+            break;
+    }
+}
+
+size_t RowCounterTable::bytes() const {
+    return table8.size() + table16.size() * 2 + table32.size() * 4;
+}
+
+const uint32_t SparseRowCounterTable::EMPTY;
+
+SparseRowCounterTable::SparseRowCounterTable(uint32_t max_count)
+    : max_count(max_count),
+      log_capacity(10),
+      num_entries(0),
+      keys(1 << log_capacity, EMPTY),
+      counts(1 << log_capacity, 0) {}
+
+size_t SparseRowCounterTable::slot(uint64_t row_id) const {
+    // fibonacci hashing, then probe linearly until the key or an empty slot
+    size_t mask = keys.size() - 1;
+    size_t idx = (row_id * 0x9E3779B97F4A7C15ull) >> (64 - log_capacity);
+    while (keys[idx] != EMPTY && keys[idx] != row_id) {
+        idx = (idx + 1) & mask;
+    }
+    return idx;
+}
+
+uint32_t SparseRowCounterTable::get(uint64_t row_id) const {
+    size_t idx = slot(row_id);
+    return keys[idx] == EMPTY ? 0 : counts[idx];
+}
+
+void SparseRowCounterTable::set(uint64_t row_id, uint32_t count) {
+    size_t idx = slot(row_id);
+    if (keys[idx] == EMPTY) {
+        if (count == 0) {
+            return;
+        }
+        // keep the load factor at most 1/2
+        if ((num_entries + 1) * 2 > keys.size()) {
+            grow();
+            idx = slot(row_id);
+        }
+        keys[idx] = static_cast<uint32_t>(row_id);
+        num_entries++;
+    }
+    counts[idx] = std::min(count, max_count);
+}
+
+void SparseRowCounterTable::grow() {
+    std::vector<uint32_t> old_keys, old_counts;
+    old_keys.swap(keys);
+    old_counts.swap(counts);
+    log_capacity++;
+    keys.assign(1 << log_capacity, EMPTY);
+    counts.assign(1 << log_capacity, 0);
+    for (size_t i = 0; i < old_keys.size(); i++) {
+        if (old_keys[i] != EMPTY) {
+            size_t idx = slot(old_keys[i]);
+            keys[idx] = old_keys[i];
+            counts[idx] = old_counts[i];
+        }
+    }
+}
+
+size_t SparseRowCounterTable::bytes() const {
+    return keys.size() * (sizeof(uint32_t) * 2);
+}
+
+CounterCache::CounterCache(int sets, int ways, const std::string& replacement)
+    : sets(sets),
+      ways(ways),
+      lines(sets * ways, Way{0, 0, false, false}),
+      stamp(0) {
+    if (replacement == "LRU") {
+        this->replacement = Replacement::LRU;
+    } else if (replacement == "FIFO") {
+        this->replacement = Replacement::FIFO;
+    } else if (replacement == "RANDOM") {
+        this->replacement = Replacement::RANDOM;
+    } else {
+        std::cerr << "Unknown counter cache replacement - " << replacement
+                  << std::endl;
+        AbruptExit(__FILE__, __LINE__);
+    }
+}
+
+bool CounterCache::access(uint64_t line, bool write, uint64_t& evicted,
+                          bool& evicted_dirty) {
+    stamp++;
+    Way* set = &lines[(line % sets) * ways];
+    Way* victim = nullptr;
+    for (int w = 0; w < ways; w++) {
+        if (set[w].valid && set[w].line == line) {
+            if (replacement == Replacement::LRU) set[w].stamp = stamp;
+            set[w].dirty |= write;
+            return true;
+        }
+        if (!set[w].valid) {
+            victim = &set[w];
+        }
+    }
+    // no free way, LRU and FIFO evict the oldest stamp
+    if (!victim) {
+        if (replacement == Replacement::RANDOM) {
+            victim = &set[gen() % ways];
+        } else {
+            victim = &set[0];
+            for (int w = 1; w < ways; w++) {
+                if (set[w].stamp < victim->stamp) victim = &set[w];
+            }
+        }
+    }
+    evicted = victim->line;
+    evicted_dirty = victim->valid && victim->dirty;
+    *victim = Way{line, stamp, true, write};
+    return false;
+}
+
+Rowhammer::Rowhammer(const Config& config)
+    : config(config),
+      bank_stride(config.rows),
+      bankgroup_stride(bank_stride * config.banks_per_group),
+      rank_stride(bankgroup_stride * config.bankgroups),
+      stats(nullptr),
+      blast_credits(config.blast_radius, 0.0) {}
+
+uint64_t Rowhammer::refreshesPerWindow() const {
+    // same schedule as Refresh::InsertRefresh
+    uint64_t interval = config.tREFI;
+    if (config.refresh_policy == RefreshPolicy::BANK_LEVEL_STAGGERED) {
+        interval = static_cast<uint64_t>(config.tREFIb) * config.banks *
+                   config.ranks;
+    }
+    return std::max<uint64_t>(1, config.tREFW / interval);
+}
+
+// one request of the text trace, text pointers refer to the read block
+struct TraceLine {
+    const char* str_addr;
+    size_t str_addr_len;
+    const char* trans_type;
+    size_t trans_type_len;
+    uint64_t hex_addr;
     uint64_t cycle;
-    int util_progress = 1;
+    Address addr;
+};
+
+static const char* skipSpace(const char* p, const char* end) {
+    while (p < end && (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n')) p++;
+    return p;
+}
+
+static const char* skipToken(const char* p, const char* end) {
+    while (p < end && !(*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n')) p++;
+    return p;
+}
+
+static uint64_t parseHex(const char* p, const char* end) {
+    if (end - p > 2 && p[0] == '0' && (p[1] == 'x' || p[1] == 'X')) p += 2;
+    uint64_t val = 0;
+    for (; p < end; p++) {
+        char c = *p;
+        if (c >= '0' && c <= '9') val = (val << 4) | (c - '0');
+        else if (c >= 'a' && c <= 'f') val = (val << 4) | (c - 'a' + 10);
+        else if (c >= 'A' && c <= 'F') val = (val << 4) | (c - 'A' + 10);
+        else break;
+    }
+    return val;
+}
+
+static uint64_t parseDec(const char* p, const char* end) {
+    uint64_t val = 0;
+    for (; p < end && *p >= '0' && *p <= '9'; p++) val = val * 10 + (*p - '0');
+    return val;
+}
+
+// parses "addr op cycle" requests from [p, end) and maps their addresses,
+// touches no shared state so blocks can be parsed in parallel
+static void parseTraceLines(const Config& config, const char* p,
+                            const char* end, std::vector<TraceLine>& lines) {
+    lines.clear();
+    while (true) {
+        TraceLine line;
+        p = skipSpace(p, end);
+        line.str_addr = p;
+        p = skipToken(p, end);
+        line.str_addr_len = p - line.str_addr;
+        p = skipSpace(p, end);
+        line.trans_type = p;
+        p = skipToken(p, end);
+        line.trans_type_len = p - line.trans_type;
+        p = skipSpace(p, end);
+        const char* cycle = p;
+        p = skipToken(p, end);
+        if (cycle == p) break;  // incomplete request, as operator>> would
+        line.cycle = parseDec(cycle, p);
+        line.hex_addr = parseHex(line.str_addr, line.str_addr + line.str_addr_len);
+        line.addr = config.AddressMapping(line.hex_addr);
+        lines.push_back(line);
+    }
+}
+
+static void appendHex(std::string& out, uint64_t val) {
+    char digits[16];
+    int n = 0;
+    do {
+        digits[n++] = "0123456789abcdef"[val & 0xf];
+        val >>= 4;
+    } while (val);
+    out += "0x";
+    while (n) out += digits[--n];
+}
+
+static void appendDec(std::string& out, uint64_t val) {
+    char digits[20];
+    int n = 0;
+    do {
+        digits[n++] = '0' + val % 10;
+        val /= 10;
+    } while (val);
+    while (n) out += digits[--n];
+}
+
+std::string Rowhammer::convertedTrace(const Config& config,
+                                      const std::string& trace_file,
+                                      int num_threads,
+                                      const std::string& format) {
+    std::string new_trace_file =
+        trace_file + "_" + config.rowhammer_scheme + "_applied";
+    bool is_cra = config.rowhammer_scheme == "CRA";
+    num_threads = std::max(num_threads, 1);
+    // one engine per channel, as in the memory controllers
+    std::vector<Rowhammer*> engines;
+    for (int c = 0; c < config.channels; c++) {
+        engines.push_back(GetRowhammer(config));
+    }
+
+    std::cout << "generating new trace file ";
+    uint64_t util_progress = 0;
     bool util_print_flag = true;
-    std::vector<string> util_aggressor;
-    while (trace >> str_addr >> trans_type >> cycle) {
-        if (util_print_flag && util_progress++ % 1000000 == 0) std::cout<<"-"<<std::flush;
-        new_trace << str_addr << " " << trans_type << " " << cycle << std::endl;
-        
-        uint64_t hex_addr;
-        std::stringstream tmp;
-        tmp << std::hex << str_addr;
-        tmp >> hex_addr;
-        Address addr = config.AddressMapping(hex_addr);
-
-        updateInfo(addr); // only for CRA
-        if (isInsertionRequired()){
-            if (util_print_flag) {
-                std::cout<<"\n";
-                util_print_flag = false;
+    std::unordered_set<uint64_t> util_aggressor;
+    std::vector<Address> no_neighbors;
+    // mitigation of one request, in trace order, returns the rows to
+    // activate after it; str_addr is the address as in the trace, if any
+    auto mitigate = [&](const Address& addr, uint64_t cycle, uint64_t hex_addr,
+                        const char* str_addr, size_t str_addr_len) {
+        if (util_print_flag && ++util_progress % 1000000 == 0) std::cout<<"-"<<std::flush;
+        Rowhammer* engine = engines[addr.channel];
+        engine->updateInfo(addr, cycle);
+        // counter accesses are only modeled inside the controller
+        engine->takeCounterTraffic();
+        if (!engine->isInsertionRequired()) {
+            return no_neighbors;
+        }
+        if (util_print_flag) {
+            std::cout<<"\n";
+            util_print_flag = false;
+        }
+        if (is_cra && util_aggressor.insert(hex_addr).second) {
+            std::string hex;
+            if (!str_addr) {
+                appendHex(hex, hex_addr);
+                str_addr = hex.data();
+                str_addr_len = hex.size();
             }
-            if (is_cra && std::find(util_aggressor.begin(), 
-                          util_aggressor.end(), 
-                          str_addr) 
-                        == util_aggressor.end()) {
-                util_aggressor.push_back(str_addr);
-                std::cout<< "Aggressor detected - "<<str_addr <<" "; print_addr(addr);
-                // std::cout<< "Add activation trace for neighbor rows" << std::endl;
+            std::cout<< "Aggressor detected - "
+                     << std::string(str_addr, str_addr_len)
+                     <<" "; print_addr(addr);
+        }
+        return engine->neighborRows(addr);
+    };
+
+    if (format != "text" || GetTraceFormat(trace_file) != "text") {
+        // request by request through the trace readers and writers,
+        // decoding on a thread of its own when threads are given
+        TraceReader* reader = GetTraceReader(trace_file, num_threads > 1);
+        TraceWriter* writer = GetTraceWriter(new_trace_file, format);
+        Transaction trans;
+        while (reader->Next(trans)) {
+            writer->Write(trans);
+            Address addr = config.AddressMapping(trans.addr);
+            int t = 0;
+            for (const auto& nei_addr :
+                 mitigate(addr, trans.added_cycle, trans.addr, nullptr, 0)) {
+                t++;
+                Transaction nei_trans(config.AddressInverseMapping(nei_addr),
+                                      false, true);
+                nei_trans.added_cycle = trans.added_cycle + t;
+                writer->Write(nei_trans);
+            }
+        }
+        delete writer;
+        delete reader;
+        if (util_print_flag) std::cout << " done" << std::endl;
+        for (auto engine : engines) {
+            delete engine;
+        }
+        return new_trace_file;
+    }
+
+    std::FILE* trace = std::fopen(trace_file.c_str(), "rb");
+    std::FILE* new_trace = std::fopen(new_trace_file.c_str(), "wb");
+    if (!trace || !new_trace) {
+        std::cerr << "Cannot open " << (trace ? new_trace_file : trace_file)
+                  << std::endl;
+        AbruptExit(__FILE__, __LINE__);
+    }
+    const size_t block_size = 8 << 20;
+    const size_t flush_size = 4 << 20;
+    std::vector<char> block(block_size);
+    std::vector<std::vector<TraceLine> > parsed(num_threads);
+    std::string out;
+    out.reserve(flush_size + 4096);
+    size_t carry = 0;
+    bool eof = false;
+    while (!eof) {
+        size_t len = carry + std::fread(block.data() + carry, 1,
+                                        block_size - carry, trace);
+        eof = len < block_size;
+        // only complete lines, the rest is carried to the next block
+        size_t cut = len;
+        if (!eof) {
+            while (cut > 0 && block[cut - 1] != '\n') cut--;
+            if (cut == 0) cut = len;  // a single line longer than the block
+        }
+
+        // parse stage, split at line boundaries
+        const char* begin = block.data();
+        const char* end = begin + cut;
+        std::vector<std::thread> threads;
+        for (int t = 0; t < num_threads; t++) {
+            const char* chunk_end = t == num_threads - 1
+                                        ? end
+                                        : begin + (end - begin) / (num_threads - t);
+            while (chunk_end < end && *chunk_end != '\n') chunk_end++;
+            if (num_threads == 1) {
+                parseTraceLines(config, begin, chunk_end, parsed[t]);
+            } else {
+                threads.emplace_back(parseTraceLines, std::cref(config), begin,
+                                     chunk_end, std::ref(parsed[t]));
+            }
+            begin = chunk_end;
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+
+        // mitigation stage, in trace order
+        for (const auto& lines : parsed) {
+            for (const auto& line : lines) {
+                out.append(line.str_addr, line.str_addr_len);
+                out += ' ';
+                out.append(line.trans_type, line.trans_type_len);
+                out += ' ';
+                appendDec(out, line.cycle);
+                out += '\n';
+
+                // assuming the procedure determining additional
+                // activations can be done in one cycle
+                int t = 0;
+                for (const auto& nei_addr :
+                     mitigate(line.addr, line.cycle, line.hex_addr,
+                              line.str_addr, line.str_addr_len)) {
+                    t++;
+                    appendHex(out, config.AddressInverseMapping(nei_addr));
+                    out += " NEI_ACT ";
+                    appendDec(out, line.cycle + t);
+                    out += '\n';
+                }
+            }
+            if (out.size() >= flush_size) {
+                std::fwrite(out.data(), 1, out.size(), new_trace);
+                out.clear();
             }
-            addTrace(addr, cycle);
         }
+
+        carry = len - cut;
+        std::memmove(block.data(), block.data() + cut, carry);
     }
+    std::fwrite(out.data(), 1, out.size(), new_trace);
+    std::fclose(trace);
+    std::fclose(new_trace);
     if (util_print_flag) std::cout << " done" << std::endl;
+    for (auto engine : engines) {
+        delete engine;
+    }
     return new_trace_file;
 }
 
-void Rowhammer::addTrace(Address addr, uint64_t cycle) {
-    // assuming the procedure determining additional
-    // activations can be done in one cycle
-    int t=0;
-    if (addr.row>0) {
-        t++;
-        Address tmp_addr(addr);
-        tmp_addr.row -= 1;
-        new_trace << AddressInverseMapping(tmp_addr) << " NEI_ACT " << cycle+t << std::endl;
-    }
-    if (addr.row<config.rows) {
-        t++;
-        Address tmp_addr(addr);
-        tmp_addr.row += 1;
-        new_trace << AddressInverseMapping(tmp_addr) << " NEI_ACT " << cycle+t << std::endl;
+std::vector<Address> Rowhammer::neighborRows(Address addr) {
+    std::vector<Address> neighbors;
+    for (int d = 1; d <= config.blast_radius; d++) {
+        blast_credits[d - 1] += config.blast_weights[d - 1];
+        if (blast_credits[d - 1] < 1.0) {
+            continue;
+        }
+        blast_credits[d - 1] -= 1.0;
+        if (addr.row >= d) {
+            Address tmp_addr(addr);
+            tmp_addr.row -= d;
+            neighbors.push_back(tmp_addr);
+        }
+        if (addr.row + d < config.rows) {
+            Address tmp_addr(addr);
+            tmp_addr.row += d;
+            neighbors.push_back(tmp_addr);
+        }
     }
+    return neighbors;
 }
 
-PRA::PRA(std::string config_file, std::string output_file, std::string trace_file, float probability)
-    : Rowhammer(config_file, output_file, trace_file, "PRA"),
-      distribution(1,1/probability)
-    {
-        p = probability;
+uint64_t CounterRNG::bernoulliThreshold(double p) {
+    if (p >= 1) return UINT64_MAX;
+    if (p <= 0) return 0;
+    return static_cast<uint64_t>(std::ldexp(p, 64));
+}
+
+std::vector<CounterRNG> Rowhammer::bankStreams(uint64_t salt) const {
+    std::vector<CounterRNG> streams;
+    for (int i = 0; i < config.channels * config.ranks * config.banks; i++) {
+        streams.emplace_back(config.rowhammer_seed, (salt << 32) | i);
     }
+    return streams;
+}
+
+PRA::PRA(const Config& config, double probability)
+    : Rowhammer(config),
+      streams(bankStreams(1)),
+      current(nullptr),
+      threshold(CounterRNG::bernoulliThreshold(probability))
+    {}
 
 PRA::~PRA() {}
 
-CRA::CRA(std::string config_file, std::string output_file, std::string trace_file, int threshold)
-    : Rowhammer(config_file, output_file, trace_file, "CRA"),
-      thd(threshold)
+CRA::CRA(const Config& config, int threshold)
+    : Rowhammer(config),
+      thd(threshold),
+      recent_row(0),
+      count_bits(0),
+      stamp_mask(0),
+      window_refreshes(refreshesPerWindow()),
+      bank_refreshes(config.ranks * config.banks, 0),
+      counter_cache(nullptr),
+      bursts_per_line(0)
     {
-        std::cout<<"Initializing counter table (with 2^" 
-                 << LogBase2(config.channels*config.ranks*config.bankgroups*config.banks*config.rows)
-                 << " number of entries)" << std::endl;
-        counter_table = new int****[config.channels];
-        for(int c=0; c<config.channels; ++c) {
-            counter_table[c]=new int***[config.ranks];
-            for(int r=0; r<config.ranks; ++r) {
-                counter_table[c][r]=new int**[config.bankgroups];
-                for (int bg=0; bg<config.bankgroups; ++bg) {
-                    counter_table[c][r][bg]=new int*[config.banks];
-                    for (int b=0;b<config.banks; ++b) {
-                        counter_table[c][r][bg][b]=new int[config.rows];
-                        for(int row=0; row<config.rows; ++row)
-                            counter_table[c][r][bg][b][row]=0;
-                    }
-                }
-            }
+        while ((1ull << count_bits) <= static_cast<uint64_t>(thd)) {
+            count_bits++;
+        }
+        uint32_t max_count = threshold;
+        if (config.cra_refresh_reset) {
+            // at least 8 stamp bits, in the narrowest entry holding them:
+            // a stale count is only kept if its row goes untouched for a
+            // multiple of 2^(stamp bits) >= 256 refresh windows
+            int width = count_bits + 8 <= 8    ? 8
+                        : count_bits + 8 <= 16 ? 16
+                                               : 32;
+            stamp_mask =
+                static_cast<uint32_t>((1ull << (width - count_bits)) - 1);
+            max_count = static_cast<uint32_t>((1ull << width) - 1);
+        }
+        if (config.cra_cache_sets > 0) {
+            counter_cache = new CounterCache(config.cra_cache_sets,
+                                             config.cra_cache_ways,
+                                             config.cra_cache_replacement);
+            // counters are kept in DRAM as packed entries, stamp included,
+            // as narrow as in RowCounterTable
+            int counter_bytes = max_count <= UINT8_MAX    ? 1
+                                : max_count <= UINT16_MAX ? 2
+                                                          : 4;
+            int line_bytes = config.cra_counters_per_line * counter_bytes;
+            bursts_per_line = (line_bytes + config.request_size_bytes - 1) /
+                              config.request_size_bytes;
         }
-        
+        if (config.cra_tracker == "sparse") {
+            counter_table = new SparseRowCounterTable(max_count);
+            return;
+        } else if (config.cra_tracker != "dense") {
+            std::cerr << "Unknown CRA tracker - " << config.cra_tracker
+                      << std::endl;
+            AbruptExit(__FILE__, __LINE__);
+        }
+        counter_table = new RowCounterTable(rowsPerChannel(), max_count);
+        std::cout<<"Initializing counter table (with 2^" 
+                 << LogBase2(rowsPerChannel())
+                 << " number of entries, "
+                 << (counter_table->bytes() >> 20) << " MB)" << std::endl;
     }
 
 CRA::~CRA() {
-    for(int c=0; c<config.channels; ++c) {
-        for(int r=0; r<config.ranks; ++r) {
-            for (int bg=0; bg<config.bankgroups; ++bg) {
-                for (int b=0;b<config.banks; ++b) {
-                    delete counter_table[c][r][bg][b];
-                }
-                delete counter_table[c][r][bg];
-            }
-            delete counter_table[c][r];
+    delete counter_table;
+    delete counter_cache;
+}
+
+void CRA::accessCounterLine(const Address& addr, uint64_t row_id) {
+    uint64_t line = row_id / config.cra_counters_per_line;
+    uint64_t evicted;
+    bool evicted_dirty;
+    // every update is a read-modify-write of the counter
+    if (!counter_cache->access(line, true, evicted, evicted_dirty)) {
+        if (evicted_dirty) {
+            addCounterTraffic(addr.channel, evicted, true);
         }
-        delete counter_table[c];
+        addCounterTraffic(addr.channel, line, false);
     }
-    delete counter_table;
 }
 
-void PRA::updateInfo(Address addr) {}
-void CRA::updateInfo(Address addr) {
-    recent_addr = addr;
-    int counter = counterFunc(addr);
+void CRA::addCounterTraffic(int channel, uint64_t line, bool is_write) {
+    // counter lines are packed into the top rows of the channel,
+    // consecutive bursts interleaved over banks, bankgroups and ranks
+    int cols = config.columns / config.BL;
+    for (int i = 0; i < bursts_per_line; i++) {
+        uint64_t burst = line * bursts_per_line + i;
+        Address addr;
+        addr.channel = channel;
+        addr.column = burst % cols;
+        burst /= cols;
+        addr.bank = burst % config.banks_per_group;
+        burst /= config.banks_per_group;
+        addr.bankgroup = burst % config.bankgroups;
+        burst /= config.bankgroups;
+        addr.rank = burst % config.ranks;
+        burst /= config.ranks;
+        addr.row = config.rows - 1 - static_cast<int>(burst);
+        Transaction trans(config.AddressInverseMapping(addr), is_write);
+        trans.is_counter = true;
+        counter_traffic.push_back(trans);
+    }
+}
+
+std::vector<Transaction> CRA::takeCounterTraffic() {
+    std::vector<Transaction> traffic;
+    traffic.swap(counter_traffic);
+    return traffic;
+}
+
+void PRA::updateInfo(Address addr, uint64_t clk) {
+    current = &streams[flatChannelBankId(addr)];
+}
+uint32_t CRA::generation(const Address& addr) const {
+    // the n-th refresh of a bank covers the rows of slot n % window, the
+    // generation of a row is the number of refreshes that covered it
+    uint64_t row_slot = static_cast<uint64_t>(addr.row) * window_refreshes /
+                        config.rows;
+    uint64_t refreshes = bank_refreshes[flatBankId(addr)];
+    return static_cast<uint32_t>(
+        (refreshes + window_refreshes - 1 - row_slot) / window_refreshes);
+}
+
+uint32_t CRA::count(const Address& addr, uint32_t entry) const {
+    // lazy reset, the row was refreshed since its last activation
+    if (stamp_mask &&
+        (entry >> count_bits) != (generation(addr) & stamp_mask)) {
+        return 0;
+    }
+    return entry & ((1ull << count_bits) - 1);
+}
+
+void CRA::updateRefresh(Address addr) {
+    if (addr.bankgroup >= 0 && addr.bank >= 0) {
+        bank_refreshes[flatBankId(addr)]++;
+        return;
+    }
+    int first = addr.rank * config.banks;
+    for (int i = first; i < first + config.banks; i++) {
+        bank_refreshes[i]++;
+    }
+}
+
+void CRA::updateInfo(Address addr, uint64_t clk) {
+    recent_row = flatRowId(addr);
+    if (counter_cache) {
+        accessCounterLine(addr, recent_row);
+    }
+    int counter = count(addr, counter_table->get(recent_row));
     if (counter==thd) {
         // previously, this row was aggressor.
         // We already handled this.
@@ -140,67 +634,597 @@ void CRA::updateInfo(Address addr) {
         counter = 0;
     }
     // Increment the counter
-    counter_table[addr.channel][addr.rank][addr.bankgroup][addr.bank][addr.row] = counter+1;
+    uint32_t stamp = stamp_mask ? generation(addr) & stamp_mask : 0;
+    counter_table->set(recent_row, (stamp << count_bits) | (counter+1));
 }
 
 bool PRA::isInsertionRequired() {
     // selected with probability p
-    return distribution(gen)==1;
+    return current && current->bernoulli(threshold);
 }
 
 bool CRA::isInsertionRequired() {
     // if the row is aggressor,
     // it must be the recent_row
-    return counterFunc(recent_addr) == thd;
+    uint32_t entry = counter_table->get(recent_row);
+    return static_cast<int>(entry & ((1ull << count_bits) - 1)) == thd;
 }
 
 int CRA::counterFunc(Address addr){
-    return counter_table[addr.channel][addr.rank][addr.bankgroup][addr.bank][addr.row];
+    return count(addr, counter_table->get(flatRowId(addr)));
 }
 
-std::string Rowhammer::AddressInverseMapping(Address addr) {
-    uint64_t hex_addr=0;
+Graphene::Graphene(const Config& config, int threshold, int entries)
+    : Rowhammer(config),
+      thd(threshold),
+      num_entries(entries),
+      window_refreshes(refreshesPerWindow()),
+      triggered(false)
+    {
+        if (num_entries <= 0) {
+            // enough entries that no row can reach thd activations in a
+            // window without being tracked: ceil(max ACTs / thd)
+            uint64_t max_acts = static_cast<uint64_t>(config.tREFW) / config.tRC;
+            num_entries = static_cast<int>((max_acts + thd - 1) / thd);
+        }
+        tables.resize(config.ranks * config.banks);
+        for (auto& table : tables) {
+            table.rows.assign(num_entries, -1);
+            table.counts.assign(num_entries, 0);
+            resetTable(table);
+        }
+        std::cout << "Graphene: " << num_entries << " entries per bank, "
+                  << "reset every " << window_refreshes << " refreshes"
+                  << std::endl;
+    }
 
-    std::map<std::string, int> field_widths, field_vals;
-    field_widths["ch"] = LogBase2(config.channels);
-    field_widths["ra"] = LogBase2(config.ranks);
-    field_widths["bg"] = LogBase2(config.bankgroups);
-    field_widths["ba"] = LogBase2(config.banks_per_group);
-    field_widths["ro"] = LogBase2(config.rows);
-    field_widths["co"] = LogBase2(config.columns) - LogBase2(config.BL);
+void Graphene::resetTable(BankTable& table) {
+    table.entry_of.clear();
+    table.by_count.clear();
+    for (int i = 0; i < num_entries; i++) {
+        table.rows[i] = -1;
+        table.counts[i] = 0;
+        table.by_count.insert(std::make_pair(0u, i));
+    }
+    table.spillover = 0;
+    table.refreshes = 0;
+}
 
-    field_vals["ch"] = addr.channel;
-    field_vals["ra"] = addr.rank;
-    field_vals["bg"] = addr.bankgroup;
-    field_vals["ba"] = addr.bank;
-    field_vals["ro"] = addr.row;
-    field_vals["co"] = addr.column; // any value (within valid range) is possible
+void Graphene::refreshBank(BankTable& table) {
+    table.refreshes++;
+    if (table.refreshes >= window_refreshes) {
+        resetTable(table);
+    }
+}
 
-    std::queue<std::string> fields;
-    std::string address_mapping = config.address_mapping;
-    for (size_t i = 0; i < address_mapping.size(); i += 2) {
-        std::string token = address_mapping.substr(i, 2);
-        fields.push(token);
+void Graphene::updateInfo(Address addr, uint64_t clk) {
+    BankTable& table = tables[flatBankId(addr)];
+    triggered = false;
+    int entry;
+    auto it = table.entry_of.find(addr.row);
+    if (it != table.entry_of.end()) {
+        entry = it->second;
+    } else {
+        // all counts are >= spillover, replace one that equals it
+        auto least = table.by_count.begin();
+        if (least->first != table.spillover) {
+            table.spillover++;
+            increment("num_graphene_spills");
+            return;
+        }
+        entry = least->second;
+        if (table.rows[entry] >= 0) {
+            table.entry_of.erase(table.rows[entry]);
+        }
+        table.rows[entry] = addr.row;
+        table.entry_of[addr.row] = entry;
+    }
+    table.by_count.erase(std::make_pair(table.counts[entry], entry));
+    table.counts[entry]++;
+    table.by_count.insert(std::make_pair(table.counts[entry], entry));
+    triggered = table.counts[entry] % thd == 0;
+}
+
+void Graphene::updateRefresh(Address addr) {
+    if (addr.bankgroup >= 0 && addr.bank >= 0) {
+        refreshBank(tables[flatBankId(addr)]);
+        return;
+    }
+    int first = addr.rank * config.banks;
+    for (int i = first; i < first + config.banks; i++) {
+        refreshBank(tables[i]);
+    }
+}
+
+bool Graphene::isInsertionRequired() { return triggered; }
+
+TRR::TRR(const Config& config, int entries, int refreshes,
+         const std::string& policy, double probability)
+    : Rowhammer(config),
+      entries(entries),
+      refreshes(refreshes),
+      tables(config.ranks * config.banks * entries, Entry{Address(), 0, false}),
+      stamp(0),
+      streams(bankStreams(2)),
+      sample_threshold(CounterRNG::bernoulliThreshold(probability))
+    {
+        if (policy == "COUNTER") {
+            this->policy = Policy::COUNTER;
+        } else if (policy == "SAMPLE") {
+            this->policy = Policy::SAMPLE;
+        } else {
+            std::cerr << "Unknown TRR policy " << policy << std::endl;
+            AbruptExit(__FILE__, __LINE__);
+        }
+    }
+
+void TRR::updateInfo(Address addr, uint64_t clk) {
+    Entry* table = &tables[flatBankId(addr) * entries];
+    Entry* victim = nullptr;
+    if (policy == Policy::COUNTER) {
+        // hit counts up, a miss replaces the least activated entry
+        for (int i = 0; i < entries; i++) {
+            if (table[i].valid && table[i].addr.row == addr.row) {
+                table[i].count++;
+                return;
+            }
+            if (!victim || !table[i].valid ||
+                (victim->valid && table[i].count < victim->count)) {
+                victim = &table[i];
+            }
+        }
+        *victim = Entry{addr, 1, true};
+    } else {
+        // a sampled activation replaces the oldest entry
+        if (!streams[flatChannelBankId(addr)].bernoulli(sample_threshold)) {
+            return;
+        }
+        for (int i = 0; i < entries; i++) {
+            if (table[i].valid && table[i].addr.row == addr.row) {
+                table[i].count = ++stamp;
+                return;
+            }
+            if (!victim || !table[i].valid ||
+                (victim->valid && table[i].count < victim->count)) {
+                victim = &table[i];
+            }
+        }
+        *victim = Entry{addr, ++stamp, true};
+    }
+}
+
+void TRR::refreshBank(int bank_id) {
+    Entry* table = &tables[bank_id * entries];
+    // the most activated (COUNTER) or most recent (SAMPLE) entries
+    for (int n = 0; n < refreshes; n++) {
+        Entry* top = nullptr;
+        for (int i = 0; i < entries; i++) {
+            if (table[i].valid && (!top || table[i].count > top->count)) {
+                top = &table[i];
+            }
+        }
+        if (!top) {
+            return;
+        }
+        aggressors.push_back(top->addr);
+        top->valid = false;
+        increment("num_trr_refreshes");
+    }
+}
+
+void TRR::updateRefresh(Address addr) {
+    if (addr.bankgroup >= 0 && addr.bank >= 0) {
+        refreshBank(flatBankId(addr));
+        return;
+    }
+    int first = addr.rank * config.banks;
+    for (int i = first; i < first + config.banks; i++) {
+        refreshBank(i);
+    }
+}
+
+std::vector<Address> TRR::takeRefreshAggressors() {
+    std::vector<Address> taken;
+    taken.swap(aggressors);
+    return taken;
+}
+
+RRS::RRS(const Config& config, int threshold, int entries)
+    : Graphene(config, threshold, entries),
+      max_swaps(config.rrs_swap_queue),
+      physical_of(config.ranks * config.banks),
+      logical_of(config.ranks * config.banks),
+      streams(bankStreams(3)),
+      swap_requests(0),
+      swap_writing(false)
+    {}
+
+int RRS::physicalRow(const Address& addr) const {
+    const auto& rows = physical_of[flatBankId(addr)];
+    auto it = rows.find(addr.row);
+    return it == rows.end() ? addr.row : it->second;
+}
+
+int RRS::logicalRow(int bank_id, int physical_row) const {
+    const auto& rows = logical_of[bank_id];
+    auto it = rows.find(physical_row);
+    return it == rows.end() ? physical_row : it->second;
+}
+
+void RRS::updateInfo(Address addr, uint64_t clk) {
+    // addr is where the ACT went, the tracker counts the logical row
+    addr.row = logicalRow(flatBankId(addr), addr.row);
+    Graphene::updateInfo(addr, clk);
+    if (!Graphene::isInsertionRequired()) {
+        return;
+    }
+    if (swaps.size() >= max_swaps) {
+        increment("num_dropped_swaps");
+        return;
+    }
+    swaps.push_back({addr, 0, 0});
+    if (swaps.size() == 1) {
+        startSwap();
+    }
+}
+
+void RRS::startSwap() {
+    // the places are picked when the swap starts, earlier swaps may have
+    // moved the aggressor
+    Swap& swap = swaps.front();
+    int physical_row = physicalRow(swap.addr);
+    auto& stream = streams[flatChannelBankId(swap.addr)];
+    int other_physical = static_cast<int>(stream.next() % (config.rows - 1));
+    if (other_physical >= physical_row) other_physical++;
+    swap.physical_row = physical_row;
+    swap.other_physical = other_physical;
+
+    // both rows are read out, then written back at the other place
+    Address physical(swap.addr);
+    physical.row = physical_row;
+    Address other(swap.addr);
+    other.row = other_physical;
+    addRowTraffic(physical, false);
+    addRowTraffic(other, false);
+    swap_requests = 2 * (config.columns / config.BL);
+    swap_writing = false;
+}
+
+void RRS::counterTrafficDone(const Transaction& trans) {
+    if (!trans.is_swap || swaps.empty() || --swap_requests > 0) {
+        return;
+    }
+    const Swap& swap = swaps.front();
+    if (!swap_writing) {
+        Address physical(swap.addr);
+        physical.row = swap.physical_row;
+        Address other(swap.addr);
+        other.row = swap.other_physical;
+        addRowTraffic(physical, true);
+        addRowTraffic(other, true);
+        swap_requests = 2 * (config.columns / config.BL);
+        swap_writing = true;
+        return;
+    }
+    finishSwap();
+    swaps.pop_front();
+    if (!swaps.empty()) {
+        startSwap();
+    }
+}
+
+void RRS::finishSwap() {
+    const Swap& swap = swaps.front();
+    int bank_id = flatBankId(swap.addr);
+    int other_logical = logicalRow(bank_id, swap.other_physical);
+    auto place = [&](int logical, int physical) {
+        if (logical == physical) {
+            physical_of[bank_id].erase(logical);
+            logical_of[bank_id].erase(physical);
+        } else {
+            physical_of[bank_id][logical] = physical;
+            logical_of[bank_id][physical] = logical;
+        }
+    };
+    place(swap.addr.row, swap.other_physical);
+    place(other_logical, swap.physical_row);
+    increment("num_row_swaps");
+}
+
+void RRS::addRowTraffic(Address addr, bool is_write) {
+    // physical addresses, swap traffic is not remapped
+    for (int col = 0; col < config.columns / config.BL; col++) {
+        addr.column = col;
+        Transaction trans(config.AddressInverseMapping(addr), is_write);
+        trans.is_swap = true;
+        swap_traffic.push_back(trans);
+    }
+}
+
+std::vector<Transaction> RRS::takeCounterTraffic() {
+    std::vector<Transaction> traffic;
+    traffic.swap(swap_traffic);
+    return traffic;
+}
+
+BlockHammer::BlockHammer(const Config& config)
+    : Rowhammer(config),
+      cbf_size(config.blockhammer_cbf_size),
+      num_hashes(config.blockhammer_hashes),
+      blacklist(config.blockhammer_blacklist),
+      epoch_length(config.tREFW),
+      delay(config.blockhammer_delay),
+      epoch(0),
+      active(0),
+      filters(2, std::vector<uint16_t>(
+                     static_cast<size_t>(config.ranks) * config.banks *
+                         config.blockhammer_cbf_size, 0)),
+      last_throttled_clk(UINT64_MAX)
+    {
+        std::cout << "BlockHammer: blacklist at " << blacklist
+                  << " ACTs, then one ACT every " << delay << " cycles"
+                  << std::endl;
+    }
+
+size_t BlockHammer::counterIndex(int bank_id, uint64_t row_id,
+                                 int hash) const {
+    // double hashing of the flat row id
+    uint64_t h1 = row_id * 0x9E3779B97F4A7C15ull;
+    uint64_t h2 = (row_id ^ (row_id >> 17)) * 0xC2B2AE3D27D4EB4Full;
+    uint64_t h = (h1 >> 32) + hash * ((h2 >> 32) | 1);
+    return static_cast<size_t>(bank_id) * cbf_size + h % cbf_size;
+}
+
+bool BlockHammer::isBlacklisted(const Address& addr) const {
+    int bank_id = flatBankId(addr);
+    uint64_t row_id = flatRowId(addr);
+    const auto& filter = filters[active];
+    for (int i = 0; i < num_hashes; i++) {
+        if (filter[counterIndex(bank_id, row_id, i)] < blacklist) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void BlockHammer::rotate(uint64_t clk) {
+    // the active filter has seen at least one full epoch, at the end of
+    // an epoch it is cleared and the other one takes over
+    uint64_t now = clk / epoch_length;
+    if (now == epoch) {
+        return;
+    }
+    if (now - epoch > 1) {
+        std::fill(filters[1 - active].begin(), filters[1 - active].end(), 0);
+    }
+    std::fill(filters[active].begin(), filters[active].end(), 0);
+    active = 1 - active;
+    epoch = now;
+    // rows whose delay has passed are not held back anymore, and an ACT
+    // waiting for more than an epoch was not issued as a tracked one
+    for (auto it = last_act.begin(); it != last_act.end();) {
+        it = clk >= it->second + delay ? last_act.erase(it) : std::next(it);
+    }
+    for (auto it = first_delayed.begin(); it != first_delayed.end();) {
+        it = clk - it->second >= epoch_length ? first_delayed.erase(it)
+                                               : std::next(it);
+    }
+    addRowDelays();
+}
+
+void BlockHammer::addRowDelays() {
+    for (const auto& row : row_delay) {
+        addValue("row_throttle_delay", static_cast<int>(row.second));
+    }
+    row_delay.clear();
+}
+
+void BlockHammer::finishStats() { addRowDelays(); }
+
+void BlockHammer::updateInfo(Address addr, uint64_t clk) {
+    rotate(clk);
+    int bank_id = flatBankId(addr);
+    uint64_t row_id = flatRowId(addr);
+    for (auto& filter : filters) {
+        for (int i = 0; i < num_hashes; i++) {
+            auto& counter = filter[counterIndex(bank_id, row_id, i)];
+            if (counter < UINT16_MAX) counter++;
+        }
+    }
+    if (isBlacklisted(addr)) {
+        last_act[row_id] = clk;
+    }
+    auto it = first_delayed.find(row_id);
+    if (it != first_delayed.end()) {
+        addValue("throttle_delay", static_cast<int>(clk - it->second));
+        row_delay[row_id] += clk - it->second;
+        first_delayed.erase(it);
+    }
+}
+
+bool BlockHammer::isActivationDelayed(const Address& addr, uint64_t clk) {
+    rotate(clk);
+    if (!isBlacklisted(addr)) {
+        return false;
+    }
+    uint64_t row_id = flatRowId(addr);
+    auto it = last_act.find(row_id);
+    if (it == last_act.end()) {
+        return false;
+    }
+    if (clk >= it->second + delay) {
+        last_act.erase(it);
+        return false;
+    }
+    first_delayed.insert(std::make_pair(row_id, clk));
+    if (clk != last_throttled_clk) {
+        last_throttled_clk = clk;
+        increment("num_throttled_cycles");
+    }
+    return true;
+}
+
+const uint32_t DisturbanceOracle::EMPTY;
+
+DisturbanceOracle::DisturbanceOracle(const Config& config, int hc_first)
+    : Rowhammer(config),
+      hc_first(hc_first),
+      window_refreshes(refreshesPerWindow()),
+      bank_refreshes(config.ranks * config.banks, 0),
+      log_capacity(10),
+      num_entries(0),
+      keys(1 << log_capacity, EMPTY),
+      counts(1 << log_capacity, 0),
+      stamps(1 << log_capacity, 0) {}
+
+size_t DisturbanceOracle::slot(uint64_t row_id) const {
+    size_t mask = keys.size() - 1;
+    size_t idx = (row_id * 0x9E3779B97F4A7C15ull) >> (64 - log_capacity);
+    while (keys[idx] != EMPTY && keys[idx] != row_id) {
+        idx = (idx + 1) & mask;
+    }
+    return idx;
+}
+
+void DisturbanceOracle::grow() {
+    std::vector<uint32_t> old_keys, old_counts, old_stamps;
+    old_keys.swap(keys);
+    old_counts.swap(counts);
+    old_stamps.swap(stamps);
+    log_capacity++;
+    keys.assign(1 << log_capacity, EMPTY);
+    counts.assign(1 << log_capacity, 0);
+    stamps.assign(1 << log_capacity, 0);
+    for (size_t i = 0; i < old_keys.size(); i++) {
+        if (old_keys[i] != EMPTY) {
+            size_t idx = slot(old_keys[i]);
+            keys[idx] = old_keys[i];
+            counts[idx] = old_counts[i];
+            stamps[idx] = old_stamps[i];
+        }
+    }
+}
+
+size_t DisturbanceOracle::bytes() const {
+    return keys.size() * (sizeof(uint32_t) * 3);
+}
+
+bool DisturbanceOracle::refreshedSince(const Address& addr,
+                                       uint32_t stamp) const {
+    // the n-th refresh of a bank covers the rows of slot n % window,
+    // find the first one at or after stamp covering this row
+    uint64_t row_slot = static_cast<uint64_t>(addr.row) * window_refreshes /
+                        config.rows;
+    uint64_t next = stamp + (row_slot + window_refreshes -
+                             stamp % window_refreshes) % window_refreshes;
+    return next < bank_refreshes[flatBankId(addr)];
+}
+
+void DisturbanceOracle::disturb(const Address& victim) {
+    uint64_t row_id = flatRowId(victim);
+    size_t idx = slot(row_id);
+    if (keys[idx] == EMPTY) {
+        if ((num_entries + 1) * 2 > keys.size()) {
+            grow();
+            idx = slot(row_id);
+        }
+        keys[idx] = static_cast<uint32_t>(row_id);
+        counts[idx] = 0;
+        num_entries++;
+    } else if (refreshedSince(victim, stamps[idx])) {
+        counts[idx] = 0;
+    }
+    stamps[idx] = bank_refreshes[flatBankId(victim)];
+    if (counts[idx] < UINT32_MAX) counts[idx]++;
+    if (counts[idx] == hc_first) {
+        increment("num_hc_first_rows");
+    }
+}
+
+void DisturbanceOracle::updateInfo(Address addr, uint64_t clk) {
+    // an activation restores the charge of the row itself
+    size_t idx = slot(flatRowId(addr));
+    if (keys[idx] != EMPTY) {
+        counts[idx] = 0;
+        stamps[idx] = bank_refreshes[flatBankId(addr)];
+    }
+    // every row within the blast radius, like the mitigations refresh
+    for (int d = 1; d <= config.blast_radius; d++) {
+        if (addr.row >= d) {
+            Address victim(addr);
+            victim.row -= d;
+            disturb(victim);
+        }
+        if (addr.row + d < config.rows) {
+            Address victim(addr);
+            victim.row += d;
+            disturb(victim);
+        }
+    }
+}
+
+void DisturbanceOracle::updateRefresh(Address addr) {
+    if (addr.bankgroup >= 0 && addr.bank >= 0) {
+        bank_refreshes[flatBankId(addr)]++;
+        return;
+    }
+    int first = addr.rank * config.banks;
+    for (int i = first; i < first + config.banks; i++) {
+        bank_refreshes[i]++;
+    }
+}
+
+uint32_t DisturbanceOracle::disturbance(const Address& addr) const {
+    size_t idx = slot(flatRowId(addr));
+    if (keys[idx] == EMPTY || refreshedSince(addr, stamps[idx])) {
+        return 0;
+    }
+    return counts[idx];
+}
+
+Rowhammer* GetRowhammer(const Config& config, SimpleStats* stats) {
+    Rowhammer* rowhammer = nullptr;
+    if (config.rowhammer_scheme == "PRA") {
+        rowhammer = new PRA(config, config.pra_probability);
+    } else if (config.rowhammer_scheme == "CRA") {
+        rowhammer = new CRA(config, config.cra_threshold);
+    } else if (config.rowhammer_scheme == "BlockHammer") {
+        rowhammer = new BlockHammer(config);
+    } else if (config.rowhammer_scheme == "Graphene") {
+        rowhammer = new Graphene(config, config.cra_threshold,
+                                 config.graphene_entries);
+    } else if (config.rowhammer_scheme == "RRS") {
+        rowhammer = new RRS(config, config.cra_threshold,
+                            config.graphene_entries);
+    } else if (config.rowhammer_scheme != "X") {
+        std::cerr << "Undefined Row Hammering Scheme - "
+                  << config.rowhammer_scheme << std::endl;
+        AbruptExit(__FILE__, __LINE__);
     }
-    while (!fields.empty()) {
-        auto token = fields.front();
-        fields.pop();
-        // push "width" amount of address 
-        // and make room for the value
-        // corresponding to the token
-        hex_addr <<= field_widths[token];
-        // write value corresponding to the token
-        hex_addr |= field_vals[token];
+    if (rowhammer) {
+        rowhammer->setStats(stats);
     }
-    hex_addr <<= config.shift_bits;
+    return rowhammer;
+}
 
-    // convert it into string
-    std::string str_addr;
-    std::stringstream tmp;
-    tmp << std::hex << hex_addr;
-    tmp >> str_addr;
-    return "0x"+str_addr;
+Rowhammer* GetTRR(const Config& config, SimpleStats* stats) {
+    if (config.trr_entries <= 0) {
+        return nullptr;
+    }
+    Rowhammer* trr = new TRR(config, config.trr_entries, config.trr_refreshes,
+                             config.trr_policy, config.trr_probability);
+    trr->setStats(stats);
+    return trr;
 }
 
+DisturbanceOracle* GetDisturbanceOracle(const Config& config,
+                                        SimpleStats* stats) {
+    if (config.hc_first <= 0) {
+        return nullptr;
+    }
+    DisturbanceOracle* oracle = new DisturbanceOracle(config, config.hc_first);
+    oracle->setStats(stats);
+    return oracle;
 }
 
+}
@@ -1,58 +1,394 @@
 #ifndef __ROWHAMMER_H
 #define __ROWHAMMER_H
 
+#include <deque>
 #include <string>
 #include <sstream>
 #include <random>
+#include <set>
+#include <unordered_map>
+#include <vector>
 
 #include "configuration.h"
+#include "simple_stats.h"
 
 namespace dramsim3 {
 
+// saturating per-row counters indexed by flat row id
+class RowCounterStore {
+    public:
+        virtual ~RowCounterStore() {}
+        virtual uint32_t get(uint64_t row_id) const = 0;
+        virtual void set(uint64_t row_id, uint32_t count) = 0;
+        virtual size_t bytes() const = 0;
+};
+
+// contiguous table of saturating counters, one per row of a channel;
+// entries are 8, 16 or 32 bits wide, the narrowest holding max_count
+class RowCounterTable : public RowCounterStore {
+    public:
+        RowCounterTable(uint64_t size, uint32_t max_count);
+        uint32_t get(uint64_t row_id) const override;
+        void set(uint64_t row_id, uint32_t count) override;
+        size_t bytes() const override;
+    private:
+        const uint32_t max_count;
+        int width;
+        std::vector<uint8_t> table8;
+        std::vector<uint16_t> table16;
+        std::vector<uint32_t> table32;
+};
+
+// open addressing (linear probing) hash of the rows touched so far,
+// memory scales with the number of activated rows instead of capacity
+class SparseRowCounterTable : public RowCounterStore {
+    public:
+        SparseRowCounterTable(uint32_t max_count);
+        uint32_t get(uint64_t row_id) const override;
+        void set(uint64_t row_id, uint32_t count) override;
+        size_t bytes() const override;
+    private:
+        static const uint32_t EMPTY = UINT32_MAX;
+        const uint32_t max_count;
+        int log_capacity;
+        size_t num_entries;
+        std::vector<uint32_t> keys;
+        std::vector<uint32_t> counts;
+        size_t slot(uint64_t row_id) const;
+        void grow();
+};
+
+// counter-based generator: draw n of a stream is a hash of (seed, stream,
+// n), so streams split per channel and bank are reproducible and share
+// no state
+class CounterRNG {
+    public:
+        CounterRNG(uint64_t seed, uint64_t stream)
+            : key(mix(seed ^ mix(stream + 0x9E3779B97F4A7C15ull))),
+              counter(0) {}
+        uint64_t next() { return mix(key + 0x9E3779B97F4A7C15ull * ++counter); }
+        // true with probability threshold / 2^64, see bernoulliThreshold
+        bool bernoulli(uint64_t threshold) {
+            return threshold == UINT64_MAX || next() < threshold;
+        }
+        static uint64_t bernoulliThreshold(double p);
+    private:
+        uint64_t key;
+        uint64_t counter;
+        // SplitMix64 finalizer
+        static uint64_t mix(uint64_t z) {
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+            return z ^ (z >> 31);
+        }
+};
+
+// set associative cache of counter lines, tags are line indices
+class CounterCache {
+    public:
+        enum class Replacement { LRU, FIFO, RANDOM };
+        CounterCache(int sets, int ways, const std::string& replacement);
+        // true on hit, on a miss the line is filled and evicted_dirty
+        // tells whether evicted (a dirty line) has to be written back
+        bool access(uint64_t line, bool write, uint64_t& evicted,
+                    bool& evicted_dirty);
+    private:
+        struct Way {
+            uint64_t line;
+            uint64_t stamp;
+            bool valid;
+            bool dirty;
+        };
+        const int sets;
+        const int ways;
+        Replacement replacement;
+        std::vector<Way> lines; //[set * ways + way]
+        uint64_t stamp;
+        std::mt19937_64 gen;
+};
+
+// An engine only sees the rows of one channel (one per controller)
 class Rowhammer {
     public:
-        Rowhammer(std::string config_file, std::string output_file, std::string trace_file, std::string method);
-        ~Rowhammer();
+        Rowhammer(const Config& config);
+        virtual ~Rowhammer() {}
 
-        std::string new_trace_file;
-        
-        std::string convertedTrace(bool is_cra);
+        // offline mode: writes a *_[scheme]_applied copy of the trace
+        // with NEI_ACT requests inserted, and returns its file name;
+        // num_threads parse a text trace, mitigation itself is sequential;
+        // the copy is written in format (see GetTraceWriter)
+        static std::string convertedTrace(const Config& config,
+                                          const std::string& trace_file,
+                                          int num_threads = 1,
+                                          const std::string& format = "text");
         virtual bool isInsertionRequired(){return false;}
-        virtual void updateInfo(Address addr){}
-        void addTrace(Address addr, uint64_t cycle);
-        std::string AddressInverseMapping(Address addr);
+        virtual void updateInfo(Address addr, uint64_t clk){}
+        // throttling engines hold back the ACT of addr at clk instead of
+        // refreshing neighbors, asked by the scheduler before every ACT
+        virtual bool isActivationDelayed(const Address& addr, uint64_t clk) {
+            return false;
+        }
+        // a REF (bankgroup and bank of -1) or REFb was issued to addr
+        virtual void updateRefresh(Address addr){}
+        // adds what the engine keeps aside to its stats, before they are
+        // printed at the end of the run
+        virtual void finishStats(){}
+        // aggressors whose neighbors are refreshed along with the last
+        // refresh command (in-DRAM mitigation)
+        virtual std::vector<Address> takeRefreshAggressors() { return {}; }
+        // DRAM requests the engine needs for its own bookkeeping since
+        // the last call, e.g. counter fills and write-backs
+        virtual std::vector<Transaction> takeCounterTraffic() { return {}; }
+        // a request of takeCounterTraffic was served, its READ or WRITE
+        // issued (or merged with a pending one)
+        virtual void counterTrafficDone(const Transaction& trans){}
+        // remapping engines move rows within their bank, the row a
+        // request to addr (logical row) is served from
+        virtual int physicalRow(const Address& addr) const { return addr.row; }
+        // rows to be activated when addr is detected as an aggressor,
+        // nearest first, within the configured blast radius
+        std::vector<Address> neighborRows(Address addr);
+        // index of the row within its channel
+        uint64_t flatRowId(const Address& addr) const {
+            return addr.rank * rank_stride + addr.bankgroup * bankgroup_stride +
+                   addr.bank * bank_stride + addr.row;
+        }
+        uint64_t rowsPerChannel() const { return config.ranks * rank_stride; }
+        // one random stream per bank of every channel, salt tells the
+        // engines apart
+        std::vector<CounterRNG> bankStreams(uint64_t salt) const;
+        int flatChannelBankId(const Address& addr) const {
+            return addr.channel * config.ranks * config.banks + flatBankId(addr);
+        }
+        int flatBankId(const Address& addr) const {
+            return (addr.rank * config.bankgroups + addr.bankgroup) *
+                   config.banks_per_group + addr.bank;
+        }
+        // refresh commands a bank receives in one tREFW
+        uint64_t refreshesPerWindow() const;
+        // engine specific counters go to the controller's stats if set
+        void setStats(SimpleStats* simple_stats) { stats = simple_stats; }
     protected:
-        Config config;
-        std::ifstream trace;
-        std::ofstream new_trace;
+        const Config& config;
+        const uint64_t bank_stride, bankgroup_stride, rank_stride;
+        SimpleStats* stats;
+        // accumulated blast_weights, a distance is due at 1
+        std::vector<double> blast_credits;
+        void increment(const std::string& name) {
+            if (stats) stats->Increment(name);
+        }
+        void addValue(const std::string& name, int value) {
+            if (stats) stats->AddValue(name, value);
+        }
 };
 
 class PRA : public Rowhammer {
     public:
-        PRA(std::string config_file, std::string output_file, std::string trace_file, float probability);
+        PRA(const Config& config, double probability);
         ~PRA();
         bool isInsertionRequired() override;
-        void updateInfo(Address addr) override;
+        void updateInfo(Address addr, uint64_t clk) override;
     private:
-        std::random_device rd;
-        std::mt19937_64 gen;
-        std::uniform_int_distribution<int> distribution;
-        float p;
+        std::vector<CounterRNG> streams;
+        CounterRNG* current; // stream of the bank last activated
+        uint64_t threshold;
 };
 
 class CRA : public Rowhammer {
     public:
-        CRA(std::string config_file, std::string output_file, std::string trace_file, int threshold);
+        CRA(const Config& config, int threshold);
         ~CRA();
         bool isInsertionRequired() override;
-        void updateInfo(Address addr) override;
+        void updateInfo(Address addr, uint64_t clk) override;
+        void updateRefresh(Address addr) override;
         int counterFunc(Address addr);
+        std::vector<Transaction> takeCounterTraffic() override;
     private:
         const int thd;
-        int ***** counter_table; //[channel][rank][bankgroup][bank][row]
-        Address recent_addr;
+        // count in the low count_bits of an entry, above it the low bits
+        // of the refresh generation it was counted in; a count of an older
+        // generation is reset when the row is touched again
+        RowCounterStore* counter_table; //[flat row id]
+        uint64_t recent_row;
+        int count_bits;
+        uint32_t stamp_mask; // 0 if counts are kept across refreshes
+
+        const uint64_t window_refreshes;
+        std::vector<uint32_t> bank_refreshes; //[flat bank id]
+        uint32_t generation(const Address& addr) const;
+        uint32_t count(const Address& addr, uint32_t entry) const;
+
+        // nullptr if counter accesses are not modeled
+        CounterCache* counter_cache;
+        int bursts_per_line;
+        std::vector<Transaction> counter_traffic;
+        void accessCounterLine(const Address& addr, uint64_t row_id);
+        void addCounterTraffic(int channel, uint64_t line, bool is_write);
 };
 
+// Misra-Gries summary of the activated rows of every bank (Graphene),
+// the table size does not depend on the rows per bank; an entry
+// reaching a multiple of the threshold triggers the mitigation
+class Graphene : public Rowhammer {
+    public:
+        Graphene(const Config& config, int threshold, int entries);
+        bool isInsertionRequired() override;
+        void updateInfo(Address addr, uint64_t clk) override;
+        void updateRefresh(Address addr) override;
+    private:
+        struct BankTable {
+            std::unordered_map<int, int> entry_of; // row -> entry
+            std::vector<int> rows;
+            std::vector<uint32_t> counts;
+            std::set<std::pair<uint32_t, int> > by_count; // (count, entry)
+            uint32_t spillover;
+            uint64_t refreshes;
+        };
+        const uint32_t thd;
+        int num_entries;
+        uint64_t window_refreshes;
+        std::vector<BankTable> tables; //[flat bank id]
+        bool triggered;
+        void resetTable(BankTable& table);
+        void refreshBank(BankTable& table);
+};
+
+// Randomized Row-Swap: a logical row reaching a multiple of the threshold
+// in the Graphene tracker swaps places with a random row of its bank;
+// the swap reads and writes back both rows through the command queue,
+// and the rows only take their new places once the writes were issued.
+// Swaps of a channel are done one at a time, a swap triggered while
+// rrs_swap_queue are pending is dropped
+class RRS : public Graphene {
+    public:
+        RRS(const Config& config, int threshold, int entries);
+        bool isInsertionRequired() override { return false; }
+        void updateInfo(Address addr, uint64_t clk) override;
+        std::vector<Transaction> takeCounterTraffic() override;
+        void counterTrafficDone(const Transaction& trans) override;
+        int physicalRow(const Address& addr) const override;
+    private:
+        struct Swap {
+            Address addr; // logical row of the aggressor
+            int physical_row;
+            int other_physical;
+        };
+        const size_t max_swaps;
+        // only the rows away from their place, per flat bank id
+        std::vector<std::unordered_map<int, int> > physical_of;
+        std::vector<std::unordered_map<int, int> > logical_of;
+        std::vector<CounterRNG> streams;
+        std::vector<Transaction> swap_traffic;
+        // the front one is in flight
+        std::deque<Swap> swaps;
+        // requests of the read-out or write-back not served yet
+        int swap_requests;
+        bool swap_writing;
+        int logicalRow(int bank_id, int physical_row) const;
+        void startSwap();
+        void finishSwap();
+        void addRowTraffic(Address addr, bool is_write);
+};
+
+// BlockHammer: activations are counted in two time-interleaved counting
+// Bloom filters per bank; a row over the blacklist threshold may only be
+// activated once every blockhammer_delay cycles, so it cannot reach the
+// rowhammer threshold within a refresh window
+class BlockHammer : public Rowhammer {
+    public:
+        BlockHammer(const Config& config);
+        void updateInfo(Address addr, uint64_t clk) override;
+        bool isActivationDelayed(const Address& addr, uint64_t clk) override;
+        void finishStats() override;
+    private:
+        const int cbf_size;
+        const int num_hashes;
+        const uint32_t blacklist;
+        const uint64_t epoch_length;
+        const uint64_t delay;
+        uint64_t epoch;
+        int active; // filter queried, the other one is younger
+        std::vector<std::vector<uint16_t> > filters; //[2][bank * cbf_size + i]
+        // last ACT of the blacklisted rows and the first cycle an ACT
+        // was held back, by flat row id; pruned when the epoch rotates
+        std::unordered_map<uint64_t, uint64_t> last_act;
+        std::unordered_map<uint64_t, uint64_t> first_delayed;
+        // cycles the ACTs of each row were held back in the epoch
+        std::unordered_map<uint64_t, uint64_t> row_delay;
+        uint64_t last_throttled_clk;
+        size_t counterIndex(int bank_id, uint64_t row_id, int hash) const;
+        bool isBlacklisted(const Address& addr) const;
+        void rotate(uint64_t clk);
+        void addRowDelays();
+};
+
+// in-DRAM Target Row Refresh: activated rows are sampled into a small
+// table per bank and the neighbors of the top entries are refreshed
+// with every REF; independent of the controller side scheme
+class TRR : public Rowhammer {
+    public:
+        enum class Policy { COUNTER, SAMPLE };
+        TRR(const Config& config, int entries, int refreshes,
+            const std::string& policy, double probability);
+        void updateInfo(Address addr, uint64_t clk) override;
+        void updateRefresh(Address addr) override;
+        std::vector<Address> takeRefreshAggressors() override;
+    private:
+        struct Entry {
+            Address addr;
+            uint32_t count; // activations, or insertion order for SAMPLE
+            bool valid;
+        };
+        const int entries;
+        const int refreshes;
+        Policy policy;
+        std::vector<Entry> tables; //[flat bank id * entries + entry]
+        std::vector<Address> aggressors;
+        uint32_t stamp;
+        std::vector<CounterRNG> streams;
+        uint64_t sample_threshold;
+        void refreshBank(int bank_id);
+};
+
+// not a mitigation: the disturbance each row received (activations of
+// the rows within the blast radius) since it was last refreshed or
+// activated, to tell whether a mitigation kept rows below HC_first; only
+// disturbed rows are stored, refreshes are applied lazily when a row is
+// touched again
+class DisturbanceOracle : public Rowhammer {
+    public:
+        DisturbanceOracle(const Config& config, int hc_first);
+        // every ACT, including the ones issued by mitigations
+        void updateInfo(Address addr, uint64_t clk) override;
+        void updateRefresh(Address addr) override;
+        uint32_t disturbance(const Address& addr) const;
+        size_t bytes() const;
+    private:
+        static const uint32_t EMPTY = UINT32_MAX;
+        const uint32_t hc_first;
+        const uint64_t window_refreshes;
+        std::vector<uint32_t> bank_refreshes; //[flat bank id]
+        // open addressing like SparseRowCounterTable, stamps are the
+        // refreshes of the bank when the count was last updated
+        int log_capacity;
+        size_t num_entries;
+        std::vector<uint32_t> keys;
+        std::vector<uint32_t> counts;
+        std::vector<uint32_t> stamps;
+        size_t slot(uint64_t row_id) const;
+        void grow();
+        bool refreshedSince(const Address& addr, uint32_t stamp) const;
+        void disturb(const Address& victim);
+};
+
+// returns nullptr if no mitigation (X) is configured
+Rowhammer* GetRowhammer(const Config& config, SimpleStats* stats = nullptr);
+// returns nullptr if TRR is disabled (0 entries)
+Rowhammer* GetTRR(const Config& config, SimpleStats* stats = nullptr);
+// returns nullptr if the oracle is disabled (hc_first of 0)
+DisturbanceOracle* GetDisturbanceOracle(const Config& config,
+                                        SimpleStats* stats = nullptr);
+
 }
 
-#endif
\ No newline at end of file
+#endif
@@ -19,7 +19,19 @@ void PrintStatText(std::ostream& where, std::string name, T value,
 SimpleStats::SimpleStats(const Config& config, int channel_id)
     : config_(config), channel_id_(channel_id) {
     // counter stats
-    InitStat("num_NEI_ACT_cmds", "counter", "Number of NEI_ACT commands (neighbor activation for preventing row hammering)");
+    InitStat("num_NEI_ACT_cmds", "counter", "Number of NEI_ACT (ROW_REFRESH) commands, neighbor row refreshes preventing row hammering");
+    InitStat("num_rowhammer_mitigations", "counter", "Number of aggressor activations triggering NEI_ACT");
+    InitStat("num_counter_reads", "counter", "Number of CRA counter fills from DRAM");
+    InitStat("num_counter_writes", "counter", "Number of CRA counter write-backs to DRAM");
+    InitStat("num_swap_reads", "counter", "Number of RRS row swap read-outs");
+    InitStat("num_swap_writes", "counter", "Number of RRS row swap write-backs");
+    InitStat("num_row_swaps", "counter", "Number of RRS row swaps");
+    InitStat("num_dropped_swaps", "counter", "Number of RRS row swaps dropped, the swap queue was full");
+    InitStat("num_hc_first_rows", "counter", "Number of times a row reached hc_first disturbance before a refresh (bit flips)");
+    InitStat("num_trr_refreshes", "counter", "Number of aggressors whose neighbors TRR refreshed with a REF");
+    InitStat("num_trr_victim_refreshes", "counter", "Number of rows TRR refreshed within a REF or RFM");
+    InitStat("num_graphene_spills", "counter", "Number of ACTs only counted by the Graphene spillover counter");
+    InitStat("num_throttled_cycles", "counter", "Number of cycles BlockHammer held back a ready ACT");
 
     InitStat("num_cycles", "counter", "Number of DRAM cycles");
     InitStat("epoch_num", "counter", "Number of epochs");
@@ -36,18 +48,20 @@ SimpleStats::SimpleStats(const Config& config, int channel_id)
     InitStat("num_ondemand_pres", "counter", "Number of ondemend PRE commands");
     InitStat("num_ref_cmds", "counter", "Number of REF commands");
     InitStat("num_refb_cmds", "counter", "Number of REFb commands");
+    InitStat("num_rfm_cmds", "counter", "Number of RFM commands");
     InitStat("num_srefe_cmds", "counter", "Number of SREFE commands");
     InitStat("num_srefx_cmds", "counter", "Number of SREFX commands");
     InitStat("hbm_dual_cmds", "counter", "Number of cycles dual cmds issued");
 
     // double stats
-    InitStat("NEI_ACT_energy", "double", "Refresh energy");
+    InitStat("NEI_ACT_energy", "double", "Neighbor row refresh (ACT+PRE) energy");
 
     InitStat("act_energy", "double", "Activation energy");
     InitStat("read_energy", "double", "Read energy");
     InitStat("write_energy", "double", "Write energy");
     InitStat("ref_energy", "double", "Refresh energy");
     InitStat("refb_energy", "double", "Refresh-bank energy");
+    InitStat("rfm_energy", "double", "Refresh management energy");
 
     // Vector counter stats
     InitVecStat("all_bank_idle_cycles", "vec_counter",
@@ -70,6 +84,15 @@ SimpleStats::SimpleStats(const Config& config, int channel_id)
     InitHistoStat("write_latency", "Write cmd latency (cycles)", 0, 200, 10);
     InitHistoStat("interarrival_latency",
                   "Request interarrival latency (cycles)", 0, 100, 10);
+    InitHistoStat("mitigation_burst_size",
+                  "Neighbor activations per mitigation burst", 0, 16, 8);
+    InitHistoStat("throttle_delay",
+                  "Cycles a blacklisted row ACT was held back by BlockHammer",
+                  0, config_.blockhammer_delay, 10);
+    InitHistoStat("row_throttle_delay",
+                  "Cycles the ACTs of a row were held back by BlockHammer "
+                  "within a refresh window",
+                  0, config_.tREFW, 10);
 
     // some irregular stats
     InitStat("average_bandwidth", "calculated", "Average bandwidth");
@@ -147,6 +170,24 @@ void SimpleStats::PrintFinalStats() {
     print_pairs_.clear();
 }
 
+double SimpleStats::GetStat(const std::string& name) const {
+    auto counter = counters_.find(name);
+    if (counter != counters_.end()) {
+        return counter->second;
+    }
+    auto value = doubles_.find(name);
+    if (value != doubles_.end()) {
+        return value->second;
+    }
+    value = calculated_.find(name);
+    if (value != calculated_.end()) {
+        return value->second;
+    }
+    std::cerr << "Unknown stat " << name << std::endl;
+    AbruptExit(__FILE__, __LINE__);
+    return 0;
+}
+
 void SimpleStats::Reset() {
     for (auto& it : counters_) {
         it.second = 0;
@@ -362,6 +403,10 @@ void SimpleStats::UpdatePrints(bool epoch) {
         print_pairs_.emplace_back(it.first, fmt::format("{}", it.second));
         j_data_[it.first] = it.second;
     }
+
+    for (const auto& it : json_stats_) {
+        j_data_[it.first] = it.second;
+    }
 }
 
 void SimpleStats::UpdateEpochStats() {
@@ -370,7 +415,7 @@ void SimpleStats::UpdateEpochStats() {
 
     // update computed stats
     doubles_["NEI_ACT_energy"] =
-        epoch_counters_["num_NEI_ACT_cmds"] * config_.ref_energy_inc;
+        epoch_counters_["num_NEI_ACT_cmds"] * config_.act_energy_inc;
 
     doubles_["act_energy"] =
         epoch_counters_["num_act_cmds"] * config_.act_energy_inc;
@@ -382,6 +427,8 @@ void SimpleStats::UpdateEpochStats() {
         epoch_counters_["num_ref_cmds"] * config_.ref_energy_inc;
     doubles_["refb_energy"] =
         epoch_counters_["num_refb_cmds"] * config_.refb_energy_inc;
+    doubles_["rfm_energy"] =
+        epoch_counters_["num_rfm_cmds"] * config_.rfm_energy_inc;
 
     // vector doubles, update first, then push
     double background_energy = 0.0;
@@ -409,7 +456,8 @@ void SimpleStats::UpdateEpochStats() {
 
     double total_energy = doubles_["act_energy"] + doubles_["read_energy"] +
                           doubles_["write_energy"] + doubles_["ref_energy"] +
-                          doubles_["refb_energy"] + doubles_["NEI_ACT_energy"] +
+                          doubles_["refb_energy"] + doubles_["rfm_energy"] +
+                          doubles_["NEI_ACT_energy"] +
                           background_energy;
                           
     calculated_["total_energy"] = total_energy;
@@ -437,7 +485,7 @@ void SimpleStats::UpdateFinalStats() {
 
     // update computed stats
     doubles_["NEI_ACT_energy"] =
-        counters_["num_NEI_ACT_cmds"] * config_.ref_energy_inc;
+        counters_["num_NEI_ACT_cmds"] * config_.act_energy_inc;
     doubles_["act_energy"] = counters_["num_act_cmds"] * config_.act_energy_inc;
     doubles_["read_energy"] =
         counters_["num_read_cmds"] * config_.read_energy_inc;
@@ -446,6 +494,7 @@ void SimpleStats::UpdateFinalStats() {
     doubles_["ref_energy"] = counters_["num_ref_cmds"] * config_.ref_energy_inc;
     doubles_["refb_energy"] =
         counters_["num_refb_cmds"] * config_.refb_energy_inc;
+    doubles_["rfm_energy"] = counters_["num_rfm_cmds"] * config_.rfm_energy_inc;
 
     // vector doubles, update first, then push
     double background_energy = 0.0;
@@ -474,7 +523,8 @@ void SimpleStats::UpdateFinalStats() {
 
     double total_energy = doubles_["act_energy"] + doubles_["read_energy"] +
                           doubles_["write_energy"] + doubles_["ref_energy"] +
-                          doubles_["refb_energy"] + doubles_["NEI_ACT_energy"] +
+                          doubles_["refb_energy"] + doubles_["rfm_energy"] +
+                          doubles_["NEI_ACT_energy"] +
                           background_energy;
     calculated_["total_energy"] = total_energy;
     calculated_["average_power"] = total_energy / counters_["num_cycles"];
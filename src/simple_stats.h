@@ -17,6 +17,11 @@ class SimpleStats {
     // incrementing counter
     void Increment(const std::string name) { epoch_counters_[name] += 1; }
 
+    // increment counter by number
+    void IncrementBy(const std::string name, uint64_t num) {
+        epoch_counters_[name] += num;
+    }
+
     // incrementing for vec counter
     void IncrementVec(const std::string name, int pos) {
         epoch_vec_counters_[name][pos] += 1;
@@ -30,6 +35,11 @@ class SimpleStats {
     // add historgram value
     void AddValue(const std::string name, const int value);
 
+    // structured stat copied as is into the next JSON output
+    void SetJsonStat(const std::string name, const nlohmann::json& value) {
+        json_stats_[name] = value;
+    }
+
     // return per rank background energy
     double RankBackgroundEnergy(const int r) const;
 
@@ -42,6 +52,10 @@ class SimpleStats {
     // Reset (usually after one phase of simulation)
     void Reset();
 
+    // overall value of a counter, double or calculated stat, only up to
+    // date after PrintFinalStats
+    double GetStat(const std::string& name) const;
+
    private:
     using VecStat = std::unordered_map<std::string, std::vector<uint64_t> >;
     using HistoCount = std::unordered_map<int, uint64_t>;
@@ -96,6 +110,8 @@ class SimpleStats {
     VecStat histo_bins_;
     VecStat epoch_histo_bins_;
 
+    std::unordered_map<std::string, Json> json_stats_;
+
     // outputs
     Json j_data_;
     std::vector<std::pair<std::string, std::string> > print_pairs_;
@@ -0,0 +1,119 @@
+#include "sweep.h"
+
+#include <atomic>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <thread>
+#include "cpu.h"
+#include "json.hpp"
+#include "trace_reader.h"
+
+namespace dramsim3 {
+
+std::vector<double> SweepRange(const std::string& range) {
+    auto tokens = StringSplit(range, ':');
+    if (tokens.size() != 3 || std::stoi(tokens[2]) < 1) {
+        std::cerr << "Invalid sweep range " << range
+                  << ", expected start:end:num" << std::endl;
+        AbruptExit(__FILE__, __LINE__);
+    }
+    double start = std::stod(tokens[0]);
+    double end = std::stod(tokens[1]);
+    int num = std::stoi(tokens[2]);
+    std::vector<double> values;
+    for (int i = 0; i < num; i++) {
+        values.push_back(num == 1 ? start
+                                  : start + (end - start) * i / (num - 1));
+    }
+    return values;
+}
+
+void RunSweep(const Config& config, const std::vector<SweepPoint>& range,
+              const std::string& output_dir, const std::string& trace_file,
+              uint64_t cycles, int num_threads, bool fast_forward) {
+    // thresholds are whole activations, points that round to the same one
+    // are simulated once
+    std::vector<SweepPoint> points;
+    for (auto point : range) {
+        if (point.scheme != "PRA") {
+            point.value = static_cast<int>(point.value + 0.5);
+        }
+        bool seen = false;
+        for (const auto& other : points) {
+            seen |= other.scheme == point.scheme && other.value == point.value;
+        }
+        if (!seen) {
+            points.push_back(point);
+        }
+    }
+
+    // parsed once, read by all the workers
+    std::vector<Transaction> trace;
+    TraceReader* trace_reader = GetTraceReader(trace_file);
+    Transaction trans;
+    while (trace_reader->Next(trans)) {
+        trace.push_back(trans);
+    }
+    delete trace_reader;
+
+    std::vector<std::string> labels;
+    for (const auto& point : points) {
+        std::ostringstream label;
+        label << point.scheme << "_" << point.value;
+        labels.push_back(label.str());
+    }
+
+    std::vector<RunSummary> results(points.size());
+    std::atomic<size_t> next_point(0);
+    auto worker = [&]() {
+        for (size_t i = next_point++; i < points.size(); i = next_point++) {
+            Config point_config(config);
+            point_config.rowhammer_scheme = points[i].scheme;
+            if (points[i].scheme == "PRA") {
+                point_config.pra_probability = points[i].value;
+            } else {
+                point_config.cra_threshold = static_cast<int>(points[i].value);
+            }
+            point_config.SetOutputSuffix(labels[i]);
+            MemoryTraceCPU cpu(point_config, output_dir, trace);
+            for (uint64_t clk = 0; clk < cycles; clk++) {
+                if (fast_forward) {
+                    clk += cpu.FastForward(cycles - clk - 1);
+                }
+                cpu.ClockTick();
+            }
+            cpu.PrintStats();
+            results[i] = cpu.Summary();
+        }
+    };
+    std::cout << "sweeping " << points.size() << " simulations on "
+              << num_threads << " threads" << std::endl;
+    std::vector<std::thread> threads;
+    for (int t = 1; t < num_threads; t++) {
+        threads.emplace_back(worker);
+    }
+    worker();
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    nlohmann::json table = nlohmann::json::array();
+    for (size_t i = 0; i < points.size(); i++) {
+        nlohmann::json row;
+        row["label"] = labels[i];
+        row["scheme"] = points[i].scheme;
+        row["value"] = points[i].value;
+        row["reqs_done"] = results[i].reqs_done;
+        row["average_read_latency"] = results[i].avg_read_latency;
+        row["total_energy"] = results[i].total_energy;
+        row["num_NEI_ACT_cmds"] = results[i].nei_acts;
+        table.push_back(row);
+    }
+    std::string table_name = config.output_prefix + "sweep.json";
+    std::ofstream table_out(table_name);
+    table_out << table.dump(2) << std::endl;
+    std::cout << "sweep results written to " << table_name << std::endl;
+}
+
+}  // namespace dramsim3
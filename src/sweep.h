@@ -0,0 +1,29 @@
+#ifndef __SWEEP_H
+#define __SWEEP_H
+
+#include <string>
+#include <vector>
+#include "configuration.h"
+
+namespace dramsim3 {
+
+// one simulation of a sweep: a scheme and its probability (PRA) or
+// threshold (CRA, Graphene)
+struct SweepPoint {
+    std::string scheme;
+    double value;
+};
+
+// "start:end:num" to num evenly spaced values, both ends included
+std::vector<double> SweepRange(const std::string& range);
+
+// simulates every point on the same trace with num_threads workers (the
+// thresholds rounded to whole activations, duplicates once), each
+// writing its own stats files; the results are collected in one JSON
+// table, <output_prefix>sweep.json; fast_forward skips idle cycles
+void RunSweep(const Config& config, const std::vector<SweepPoint>& points,
+              const std::string& output_dir, const std::string& trace_file,
+              uint64_t cycles, int num_threads, bool fast_forward = false);
+
+}  // namespace dramsim3
+#endif
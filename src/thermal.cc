@@ -492,6 +492,7 @@ void ThermalCalculator::UpdateCMDPower(const int channel, const Command &cmd,
     } else {
         switch (cmd.cmd_type) {
             case CommandType::ACTIVATE:
+            case CommandType::ROW_REFRESH:
                 energy = config_.act_energy_inc;
                 break;
             case CommandType::READ:
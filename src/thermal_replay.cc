@@ -90,10 +90,12 @@ void ThermalReplay::ParseLine(std::string line, uint64_t &clk, Command &cmd) {
         {"write_p", CommandType::WRITE_PRECHARGE},
         {"activate", CommandType::ACTIVATE},
         {"precharge", CommandType::PRECHARGE},
+        {"row_refresh", CommandType::ROW_REFRESH},
         {"refresh_bank", CommandType::REFRESH_BANK},  // verilog model doesn't
                                                       // distinguish bank/rank
                                                       // refresh
         {"refresh", CommandType::REFRESH},
+        {"rfm", CommandType::RFM},
         {"self_refresh_enter", CommandType::SREF_ENTER},
         {"self_refresh_exit", CommandType::SREF_EXIT},
     };
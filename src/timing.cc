@@ -50,11 +50,16 @@ Timing::Timing(const Config& config)
     int activate_to_refresh =
         config.tRC;  // need to precharge before ref, so it's tRC
 
+    // a row refresh is an ACT followed by a PRE as soon as tRAS allows,
+    // so the bank is busy for tRAS + tRP and no data bus is used
+    int row_refresh_to_activate = config.tRAS + config.tRP;
+
     // TODO: deal with different refresh rate
     int refresh_to_refresh =
         config.tREFI;  // refresh intervals (per rank level)
     int refresh_to_activate = config.tRFC;  // tRFC is defined as ref to act
     int refresh_to_activate_bank = config.tRFCb;
+    int rfm_to_activate = config.tRFM;
 
     int self_refresh_entry_to_exit = config.tCKESR;
     int self_refresh_exit = config.tXS;
@@ -131,8 +136,10 @@ Timing::Timing(const Config& config)
     same_bank[static_cast<int>(CommandType::READ_PRECHARGE)] =
         std::vector<std::pair<CommandType, int> >{
             {CommandType::ACTIVATE, readp_to_act},
+            {CommandType::ROW_REFRESH, readp_to_act},
             {CommandType::REFRESH, read_to_activate},
             {CommandType::REFRESH_BANK, read_to_activate},
+            {CommandType::RFM, read_to_activate},
             {CommandType::SREF_ENTER, read_to_activate}};
     other_banks_same_bankgroup[static_cast<int>(CommandType::READ_PRECHARGE)] =
         std::vector<std::pair<CommandType, int> >{
@@ -157,8 +164,10 @@ Timing::Timing(const Config& config)
     same_bank[static_cast<int>(CommandType::WRITE_PRECHARGE)] =
         std::vector<std::pair<CommandType, int> >{
             {CommandType::ACTIVATE, write_to_activate},
+            {CommandType::ROW_REFRESH, write_to_activate},
             {CommandType::REFRESH, write_to_activate},
             {CommandType::REFRESH_BANK, write_to_activate},
+            {CommandType::RFM, write_to_activate},
             {CommandType::SREF_ENTER, write_to_activate}};
     other_banks_same_bankgroup[static_cast<int>(CommandType::WRITE_PRECHARGE)] =
         std::vector<std::pair<CommandType, int> >{
@@ -183,6 +192,7 @@ Timing::Timing(const Config& config)
     same_bank[static_cast<int>(CommandType::ACTIVATE)] =
         std::vector<std::pair<CommandType, int> >{
             {CommandType::ACTIVATE, activate_to_activate},
+            {CommandType::ROW_REFRESH, activate_to_activate},
             {CommandType::READ, activate_to_read},
             {CommandType::WRITE, activate_to_write},
             {CommandType::READ_PRECHARGE, activate_to_read},
@@ -193,19 +203,45 @@ Timing::Timing(const Config& config)
     other_banks_same_bankgroup[static_cast<int>(CommandType::ACTIVATE)] =
         std::vector<std::pair<CommandType, int> >{
             {CommandType::ACTIVATE, activate_to_activate_l},
+            {CommandType::ROW_REFRESH, activate_to_activate_l},
             {CommandType::REFRESH_BANK, activate_to_refresh}};
 
     other_bankgroups_same_rank[static_cast<int>(CommandType::ACTIVATE)] =
         std::vector<std::pair<CommandType, int> >{
             {CommandType::ACTIVATE, activate_to_activate_s},
+            {CommandType::ROW_REFRESH, activate_to_activate_s},
+            {CommandType::REFRESH_BANK, activate_to_refresh}};
+
+    // command ROW_REFRESH
+    same_bank[static_cast<int>(CommandType::ROW_REFRESH)] =
+        std::vector<std::pair<CommandType, int> >{
+            {CommandType::ACTIVATE, row_refresh_to_activate},
+            {CommandType::ROW_REFRESH, row_refresh_to_activate},
+            {CommandType::REFRESH, row_refresh_to_activate},
+            {CommandType::REFRESH_BANK, row_refresh_to_activate},
+            {CommandType::RFM, row_refresh_to_activate},
+            {CommandType::SREF_ENTER, row_refresh_to_activate}};
+
+    other_banks_same_bankgroup[static_cast<int>(CommandType::ROW_REFRESH)] =
+        std::vector<std::pair<CommandType, int> >{
+            {CommandType::ACTIVATE, activate_to_activate_l},
+            {CommandType::ROW_REFRESH, activate_to_activate_l},
+            {CommandType::REFRESH_BANK, activate_to_refresh}};
+
+    other_bankgroups_same_rank[static_cast<int>(CommandType::ROW_REFRESH)] =
+        std::vector<std::pair<CommandType, int> >{
+            {CommandType::ACTIVATE, activate_to_activate_s},
+            {CommandType::ROW_REFRESH, activate_to_activate_s},
             {CommandType::REFRESH_BANK, activate_to_refresh}};
 
     // command PRECHARGE
     same_bank[static_cast<int>(CommandType::PRECHARGE)] =
         std::vector<std::pair<CommandType, int> >{
             {CommandType::ACTIVATE, precharge_to_activate},
+            {CommandType::ROW_REFRESH, precharge_to_activate},
             {CommandType::REFRESH, precharge_to_activate},
             {CommandType::REFRESH_BANK, precharge_to_activate},
+            {CommandType::RFM, precharge_to_activate},
             {CommandType::SREF_ENTER, precharge_to_activate}};
 
     // for those who need tPPD
@@ -225,28 +261,44 @@ Timing::Timing(const Config& config)
     same_rank[static_cast<int>(CommandType::REFRESH_BANK)] =
         std::vector<std::pair<CommandType, int> >{
             {CommandType::ACTIVATE, refresh_to_activate_bank},
+            {CommandType::ROW_REFRESH, refresh_to_activate_bank},
             {CommandType::REFRESH, refresh_to_activate_bank},
             {CommandType::REFRESH_BANK, refresh_to_activate_bank},
+            {CommandType::RFM, refresh_to_activate_bank},
             {CommandType::SREF_ENTER, refresh_to_activate_bank}};
 
     other_banks_same_bankgroup[static_cast<int>(CommandType::REFRESH_BANK)] =
         std::vector<std::pair<CommandType, int> >{
             {CommandType::ACTIVATE, refresh_to_activate},
+            {CommandType::ROW_REFRESH, refresh_to_activate},
             {CommandType::REFRESH_BANK, refresh_to_refresh},
         };
 
     other_bankgroups_same_rank[static_cast<int>(CommandType::REFRESH_BANK)] =
         std::vector<std::pair<CommandType, int> >{
             {CommandType::ACTIVATE, refresh_to_activate},
+            {CommandType::ROW_REFRESH, refresh_to_activate},
             {CommandType::REFRESH_BANK, refresh_to_refresh},
         };
 
+    // command RFM, the bank is busy for tRFM
+    same_bank[static_cast<int>(CommandType::RFM)] =
+        std::vector<std::pair<CommandType, int> >{
+            {CommandType::ACTIVATE, rfm_to_activate},
+            {CommandType::ROW_REFRESH, rfm_to_activate},
+            {CommandType::REFRESH, rfm_to_activate},
+            {CommandType::REFRESH_BANK, rfm_to_activate},
+            {CommandType::RFM, rfm_to_activate},
+            {CommandType::SREF_ENTER, rfm_to_activate}};
+
     // REFRESH, SREF_ENTER and SREF_EXIT are isued to the entire
     // rank  command REFRESH
     same_rank[static_cast<int>(CommandType::REFRESH)] =
         std::vector<std::pair<CommandType, int> >{
             {CommandType::ACTIVATE, refresh_to_activate},
+            {CommandType::ROW_REFRESH, refresh_to_activate},
             {CommandType::REFRESH, refresh_to_activate},
+            {CommandType::RFM, refresh_to_activate},
             {CommandType::SREF_ENTER, refresh_to_activate}};
 
     // command SREF_ENTER
@@ -259,8 +311,10 @@ Timing::Timing(const Config& config)
     same_rank[static_cast<int>(CommandType::SREF_EXIT)] =
         std::vector<std::pair<CommandType, int> >{
             {CommandType::ACTIVATE, self_refresh_exit},
+            {CommandType::ROW_REFRESH, self_refresh_exit},
             {CommandType::REFRESH, self_refresh_exit},
             {CommandType::REFRESH_BANK, self_refresh_exit},
+            {CommandType::RFM, self_refresh_exit},
             {CommandType::SREF_ENTER, self_refresh_exit}};
 }
 
@@ -0,0 +1,451 @@
+#include "trace_reader.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace dramsim3 {
+
+const char BinaryTraceReader::kMagic[8] = {'D', 'R', 'S', '3',
+                                           'B', 'T', 'R', '1'};
+const char CompressedTraceReader::kMagic[8] = {'D', 'R', 'S', '3',
+                                               'C', 'T', 'R', '1'};
+const char CompressedTraceReader::kIndexMagic[8] = {'D', 'R', 'S', '3',
+                                                    'C', 'I', 'D', 'X'};
+
+namespace {
+uint64_t GetLittleEndian(const unsigned char* p, int bytes) {
+    uint64_t val = 0;
+    for (int i = bytes - 1; i >= 0; i--) val = (val << 8) | p[i];
+    return val;
+}
+
+void PutLittleEndian(std::vector<unsigned char>& out, uint64_t val,
+                     int bytes) {
+    for (int i = 0; i < bytes; i++) out.push_back((val >> (8 * i)) & 0xff);
+}
+
+uint64_t GetVarint(const std::vector<unsigned char>& in, size_t& pos) {
+    uint64_t val = 0;
+    for (int shift = 0; pos < in.size() && shift < 64; shift += 7) {
+        unsigned char byte = in[pos++];
+        val |= static_cast<uint64_t>(byte & 0x7f) << shift;
+        if (!(byte & 0x80)) {
+            return val;
+        }
+    }
+    std::cerr << "Corrupted compressed trace block" << std::endl;
+    AbruptExit(__FILE__, __LINE__);
+    return val;
+}
+
+void PutVarint(std::vector<unsigned char>& out, uint64_t val) {
+    while (val >= 0x80) {
+        out.push_back((val & 0x7f) | 0x80);
+        val >>= 7;
+    }
+    out.push_back(val);
+}
+
+// small deltas of either sign as small unsigned values
+uint64_t Zigzag(uint64_t delta) {
+    return (delta << 1) ^ static_cast<uint64_t>(static_cast<int64_t>(delta) >> 63);
+}
+
+uint64_t Unzigzag(uint64_t val) { return (val >> 1) ^ (~(val & 1) + 1); }
+
+uint32_t OpOf(const Transaction& trans) {
+    return trans.is_NEI_ACT ? BinaryTraceReader::NEI_ACT
+           : trans.is_write ? BinaryTraceReader::WRITE
+                            : BinaryTraceReader::READ;
+}
+}  // namespace
+
+TextTraceReader::TextTraceReader(const std::string& trace_file)
+    : trace_file_(trace_file) {
+    if (trace_file_.fail()) {
+        std::cerr << "Trace file does not exist" << std::endl;
+        AbruptExit(__FILE__, __LINE__);
+    }
+}
+
+bool TextTraceReader::Next(Transaction& trans) {
+    return static_cast<bool>(trace_file_ >> trans);
+}
+
+BinaryTraceReader::BinaryTraceReader(const std::string& trace_file)
+    : data_(nullptr), size_(0), pos_(sizeof(kMagic)), cycle_(0) {
+    int fd = open(trace_file.c_str(), O_RDONLY);
+    struct stat st;
+    if (fd < 0 || fstat(fd, &st) != 0) {
+        std::cerr << "Trace file does not exist" << std::endl;
+        AbruptExit(__FILE__, __LINE__);
+    }
+    size_ = static_cast<size_t>(st.st_size);
+    void* data = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED || size_ < sizeof(kMagic) ||
+        std::memcmp(data, kMagic, sizeof(kMagic)) != 0) {
+        std::cerr << "Not a binary trace " << trace_file << std::endl;
+        AbruptExit(__FILE__, __LINE__);
+    }
+    madvise(data, size_, MADV_SEQUENTIAL);
+    data_ = static_cast<const unsigned char*>(data);
+}
+
+BinaryTraceReader::~BinaryTraceReader() {
+    munmap(const_cast<unsigned char*>(data_), size_);
+}
+
+bool BinaryTraceReader::Next(Transaction& trans) {
+    while (pos_ + kRecordBytes <= size_) {
+        const unsigned char* record = data_ + pos_;
+        pos_ += kRecordBytes;
+        uint64_t addr = GetLittleEndian(record, 8);
+        uint32_t word = GetLittleEndian(record + 8, 4);
+        int op = word >> 30;
+        if (op == CYCLE) {
+            cycle_ = addr;
+            continue;
+        }
+        cycle_ += word & kMaxDelta;
+        trans = Transaction(addr, op == WRITE, op == NEI_ACT);
+        trans.added_cycle = cycle_;
+        return true;
+    }
+    return false;
+}
+
+CompressedTraceReader::CompressedTraceReader(const std::string& trace_file)
+    : trace_file_(trace_file, std::ios::binary) {
+    if (trace_file_.fail()) {
+        std::cerr << "Trace file does not exist" << std::endl;
+        AbruptExit(__FILE__, __LINE__);
+    }
+    trace_file_.seekg(0, std::ios::end);
+    uint64_t size = trace_file_.tellg();
+    unsigned char footer[kFooterBytes];
+    char magic[sizeof(kMagic)] = {0};
+    trace_file_.seekg(0);
+    trace_file_.read(magic, sizeof(magic));
+    if (size >= sizeof(kMagic) + kFooterBytes) {
+        trace_file_.seekg(size - kFooterBytes);
+        trace_file_.read(reinterpret_cast<char*>(footer), kFooterBytes);
+    }
+    if (!trace_file_ || std::memcmp(magic, kMagic, sizeof(kMagic)) != 0 ||
+        std::memcmp(footer + 16, kIndexMagic, sizeof(kIndexMagic)) != 0) {
+        std::cerr << "Not a complete compressed trace " << trace_file
+                  << std::endl;
+        AbruptExit(__FILE__, __LINE__);
+    }
+    uint64_t index_offset = GetLittleEndian(footer, 8);
+    uint64_t num_blocks = GetLittleEndian(footer + 8, 8);
+    std::vector<unsigned char> index(num_blocks * 24);
+    trace_file_.seekg(index_offset);
+    trace_file_.read(reinterpret_cast<char*>(index.data()), index.size());
+    for (uint64_t b = 0; b < num_blocks; b++) {
+        const unsigned char* entry = index.data() + b * 24;
+        index_.push_back(BlockInfo{GetLittleEndian(entry, 8),
+                                   GetLittleEndian(entry + 8, 8),
+                                   GetLittleEndian(entry + 16, 8)});
+    }
+    trace_file_.seekg(sizeof(kMagic));
+}
+
+bool CompressedTraceReader::ReadBlock() {
+    if (next_block_ >= index_.size()) {
+        return false;
+    }
+    unsigned char header[8];
+    trace_file_.read(reinterpret_cast<char*>(header), sizeof(header));
+    block_.resize(GetLittleEndian(header, 4));
+    trace_file_.read(reinterpret_cast<char*>(block_.data()), block_.size());
+    if (!trace_file_) {
+        std::cerr << "Truncated compressed trace block " << next_block_
+                  << std::endl;
+        AbruptExit(__FILE__, __LINE__);
+    }
+    records_left_ = GetLittleEndian(header + 4, 4);
+    pos_ = 0;
+    addr_ = 0;
+    cycle_ = 0;
+    next_block_++;
+    return true;
+}
+
+bool CompressedTraceReader::Next(Transaction& trans) {
+    while (records_left_ == 0) {
+        if (!ReadBlock()) {
+            return false;
+        }
+    }
+    addr_ += Unzigzag(GetVarint(block_, pos_));
+    uint64_t word = GetVarint(block_, pos_);
+    cycle_ += Unzigzag(word >> 2);
+    records_left_--;
+    int op = word & 3;
+    trans = Transaction(addr_, op == BinaryTraceReader::WRITE,
+                        op == BinaryTraceReader::NEI_ACT);
+    trans.added_cycle = cycle_;
+    return true;
+}
+
+void CompressedTraceReader::SeekCycle(uint64_t clk) {
+    // requests at clk may start in the block before the first one
+    // starting at or after clk
+    auto later = std::lower_bound(
+        index_.begin(), index_.end(), clk,
+        [](const BlockInfo& block, uint64_t c) {
+            return block.first_cycle < c;
+        });
+    next_block_ = later == index_.begin() ? 0 : later - index_.begin() - 1;
+    records_left_ = 0;
+    if (next_block_ < index_.size()) {
+        trace_file_.clear();
+        trace_file_.seekg(index_[next_block_].offset);
+    }
+    Transaction trans;
+    while (records_left_ > 0 || ReadBlock()) {
+        size_t pos = pos_;
+        uint64_t addr = addr_, cycle = cycle_;
+        Next(trans);
+        if (trans.added_cycle >= clk) {
+            // hand the request out again on the next call
+            pos_ = pos;
+            addr_ = addr;
+            cycle_ = cycle;
+            records_left_++;
+            return;
+        }
+    }
+}
+
+PrefetchTraceReader::PrefetchTraceReader(TraceReader* reader)
+    : reader_(reader),
+      ring_(kRingSize),
+      head_(0),
+      tail_(0),
+      done_(false),
+      stop_(false),
+      thread_(&PrefetchTraceReader::Produce, this) {}
+
+PrefetchTraceReader::~PrefetchTraceReader() {
+    stop_ = true;
+    thread_.join();
+    delete reader_;
+}
+
+void PrefetchTraceReader::Produce() {
+    Transaction trans;
+    while (!stop_ && reader_->Next(trans)) {
+        uint64_t tail = tail_.load(std::memory_order_relaxed);
+        // full: the simulation is behind, no hurry
+        while (tail - head_.load(std::memory_order_acquire) == kRingSize) {
+            if (stop_) {
+                return;
+            }
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+        }
+        ring_[tail & (kRingSize - 1)] = trans;
+        tail_.store(tail + 1, std::memory_order_release);
+    }
+    done_.store(true, std::memory_order_release);
+}
+
+bool PrefetchTraceReader::Next(Transaction& trans) {
+    uint64_t head = head_.load(std::memory_order_relaxed);
+    while (head == tail_.load(std::memory_order_acquire)) {
+        if (done_.load(std::memory_order_acquire)) {
+            // the last requests may have landed before done_ was set
+            if (head == tail_.load(std::memory_order_acquire)) {
+                return false;
+            }
+            break;
+        }
+        std::this_thread::yield();
+    }
+    trans = ring_[head & (kRingSize - 1)];
+    head_.store(head + 1, std::memory_order_release);
+    return true;
+}
+
+TextTraceWriter::TextTraceWriter(const std::string& trace_file)
+    : trace_file_(trace_file) {
+    if (trace_file_.fail()) {
+        std::cerr << "Cannot open " << trace_file << std::endl;
+        AbruptExit(__FILE__, __LINE__);
+    }
+}
+
+void TextTraceWriter::Write(const Transaction& trans) {
+    trace_file_ << "0x" << std::hex << std::uppercase << trans.addr
+                << std::dec << " "
+                << (trans.is_NEI_ACT ? "NEI_ACT"
+                                     : trans.is_write ? "WRITE" : "READ")
+                << " " << trans.added_cycle << "\n";
+}
+
+BinaryTraceWriter::BinaryTraceWriter(const std::string& trace_file)
+    : trace_file_(trace_file, std::ios::binary),
+      buffer_(BinaryTraceReader::kMagic,
+              BinaryTraceReader::kMagic + sizeof(BinaryTraceReader::kMagic)) {
+    if (trace_file_.fail()) {
+        std::cerr << "Cannot open " << trace_file << std::endl;
+        AbruptExit(__FILE__, __LINE__);
+    }
+}
+
+BinaryTraceWriter::~BinaryTraceWriter() {
+    trace_file_.write(reinterpret_cast<const char*>(buffer_.data()),
+                      buffer_.size());
+}
+
+void BinaryTraceWriter::Put(uint64_t addr, uint32_t word) {
+    PutLittleEndian(buffer_, addr, 8);
+    PutLittleEndian(buffer_, word, 4);
+    if (buffer_.size() >= (4 << 20)) {
+        trace_file_.write(reinterpret_cast<const char*>(buffer_.data()),
+                          buffer_.size());
+        buffer_.clear();
+    }
+}
+
+void BinaryTraceWriter::Write(const Transaction& trans) {
+    uint64_t delta = trans.added_cycle - cycle_;
+    if (trans.added_cycle < cycle_ || delta > BinaryTraceReader::kMaxDelta) {
+        Put(trans.added_cycle,
+            static_cast<uint32_t>(BinaryTraceReader::CYCLE) << 30);
+        delta = 0;
+    }
+    Put(trans.addr, (OpOf(trans) << 30) | static_cast<uint32_t>(delta));
+    cycle_ = trans.added_cycle;
+}
+
+CompressedTraceWriter::CompressedTraceWriter(const std::string& trace_file)
+    : trace_file_(trace_file, std::ios::binary),
+      offset_(sizeof(CompressedTraceReader::kMagic)) {
+    if (trace_file_.fail()) {
+        std::cerr << "Cannot open " << trace_file << std::endl;
+        AbruptExit(__FILE__, __LINE__);
+    }
+    trace_file_.write(CompressedTraceReader::kMagic,
+                      sizeof(CompressedTraceReader::kMagic));
+}
+
+CompressedTraceWriter::~CompressedTraceWriter() {
+    FlushBlock();
+    std::vector<unsigned char> tail;
+    for (const auto& block : index_) {
+        PutLittleEndian(tail, block.offset, 8);
+        PutLittleEndian(tail, block.first_cycle, 8);
+        PutLittleEndian(tail, block.first_trans, 8);
+    }
+    PutLittleEndian(tail, offset_, 8);
+    PutLittleEndian(tail, index_.size(), 8);
+    tail.insert(tail.end(), CompressedTraceReader::kIndexMagic,
+                CompressedTraceReader::kIndexMagic +
+                    sizeof(CompressedTraceReader::kIndexMagic));
+    trace_file_.write(reinterpret_cast<const char*>(tail.data()), tail.size());
+}
+
+void CompressedTraceWriter::Write(const Transaction& trans) {
+    if (block_records_ == 0) {
+        index_.push_back(CompressedTraceReader::BlockInfo{
+            offset_, trans.added_cycle, num_trans_});
+        addr_ = 0;
+        cycle_ = 0;
+    }
+    PutVarint(block_, Zigzag(trans.addr - addr_));
+    PutVarint(block_, (Zigzag(trans.added_cycle - cycle_) << 2) | OpOf(trans));
+    addr_ = trans.addr;
+    cycle_ = trans.added_cycle;
+    num_trans_++;
+    if (++block_records_ == CompressedTraceReader::kBlockRecords) {
+        FlushBlock();
+    }
+}
+
+void CompressedTraceWriter::FlushBlock() {
+    if (block_records_ == 0) {
+        return;
+    }
+    std::vector<unsigned char> header;
+    PutLittleEndian(header, block_.size(), 4);
+    PutLittleEndian(header, block_records_, 4);
+    trace_file_.write(reinterpret_cast<const char*>(header.data()),
+                      header.size());
+    trace_file_.write(reinterpret_cast<const char*>(block_.data()),
+                      block_.size());
+    offset_ += header.size() + block_.size();
+    block_.clear();
+    block_records_ = 0;
+}
+
+std::string GetTraceFormat(const std::string& trace_file) {
+    char magic[sizeof(BinaryTraceReader::kMagic)] = {0};
+    std::ifstream probe(trace_file, std::ios::binary);
+    if (probe.fail()) {
+        std::cerr << "Trace file does not exist" << std::endl;
+        AbruptExit(__FILE__, __LINE__);
+    }
+    probe.read(magic, sizeof(magic));
+    if (probe.gcount() == sizeof(magic)) {
+        if (std::memcmp(magic, BinaryTraceReader::kMagic, sizeof(magic)) == 0) {
+            return "binary";
+        }
+        if (std::memcmp(magic, CompressedTraceReader::kMagic,
+                        sizeof(magic)) == 0) {
+            return "compressed";
+        }
+    }
+    return "text";
+}
+
+TraceReader* GetTraceReader(const std::string& trace_file, bool prefetch) {
+    std::string format = GetTraceFormat(trace_file);
+    TraceReader* reader;
+    if (format == "binary") {
+        reader = new BinaryTraceReader(trace_file);
+    } else if (format == "compressed") {
+        reader = new CompressedTraceReader(trace_file);
+    } else {
+        reader = new TextTraceReader(trace_file);
+    }
+    return prefetch ? new PrefetchTraceReader(reader) : reader;
+}
+
+TraceWriter* GetTraceWriter(const std::string& trace_file,
+                            const std::string& format) {
+    if (format == "text") {
+        return new TextTraceWriter(trace_file);
+    } else if (format == "binary") {
+        return new BinaryTraceWriter(trace_file);
+    } else if (format == "compressed") {
+        return new CompressedTraceWriter(trace_file);
+    }
+    std::cerr << "Unknown trace format " << format << std::endl;
+    AbruptExit(__FILE__, __LINE__);
+    return nullptr;
+}
+
+uint64_t ConvertTrace(const std::string& trace_file,
+                      const std::string& new_trace_file,
+                      const std::string& format) {
+    TraceReader* reader = GetTraceReader(trace_file);
+    TraceWriter* writer = GetTraceWriter(new_trace_file, format);
+    uint64_t num_trans = 0;
+    Transaction trans;
+    while (reader->Next(trans)) {
+        writer->Write(trans);
+        num_trans++;
+    }
+    delete writer;
+    delete reader;
+    return num_trans;
+}
+
+}  // namespace dramsim3
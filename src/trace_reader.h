@@ -0,0 +1,188 @@
+#ifndef __TRACE_READER_H
+#define __TRACE_READER_H
+
+#include <atomic>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "common.h"
+
+namespace dramsim3 {
+
+// sequential source of trace requests, whatever the file format
+class TraceReader {
+   public:
+    virtual ~TraceReader() {}
+    // false once the trace is exhausted
+    virtual bool Next(Transaction& trans) = 0;
+};
+
+// "addr op cycle" lines, as written by the trace generators
+class TextTraceReader : public TraceReader {
+   public:
+    TextTraceReader(const std::string& trace_file);
+    bool Next(Transaction& trans) override;
+
+   private:
+    std::ifstream trace_file_;
+};
+
+// Binary trace: an 8 byte magic followed by 12 byte little-endian records,
+// the 64-bit address and a 32-bit word of the op (top 2 bits) and the
+// cycle delta to the previous request (low 30 bits). Op 3 is no request,
+// it sets the cycle of the following ones to the address field, for
+// deltas that do not fit or go backwards.
+class BinaryTraceReader : public TraceReader {
+   public:
+    static const char kMagic[8];
+    enum Op { READ = 0, WRITE = 1, NEI_ACT = 2, CYCLE = 3 };
+    static const int kRecordBytes = 12;
+    static const uint32_t kMaxDelta = (1u << 30) - 1;
+
+    BinaryTraceReader(const std::string& trace_file);
+    ~BinaryTraceReader();
+    bool Next(Transaction& trans) override;
+
+   private:
+    const unsigned char* data_;  // memory mapped file
+    size_t size_;
+    size_t pos_;
+    uint64_t cycle_;
+};
+
+// Compressed trace, streamed block by block: an 8 byte magic, blocks of
+// up to kBlockRecords requests, the block index and a footer. A block is
+// a header of two little-endian uint32 (payload bytes, requests) and the
+// requests as varints: the zigzag address delta, then the zigzag cycle
+// delta shifted left by 2 with the op in the low bits. Deltas restart
+// from 0 in every block, so any block decodes on its own. The index
+// holds the file offset, first cycle and first request number of every
+// block (uint64 each); the footer is the index offset, the number of
+// blocks and kIndexMagic.
+class CompressedTraceReader : public TraceReader {
+   public:
+    static const char kMagic[8];
+    static const char kIndexMagic[8];
+    static const int kBlockRecords = 65536;
+    static const int kFooterBytes = 24;
+    struct BlockInfo {
+        uint64_t offset;
+        uint64_t first_cycle;
+        uint64_t first_trans;
+    };
+
+    CompressedTraceReader(const std::string& trace_file);
+    bool Next(Transaction& trans) override;
+    // starts over at the first block that may hold requests of clk, and
+    // skips its requests before clk (for a trace sorted by cycle)
+    void SeekCycle(uint64_t clk);
+    const std::vector<BlockInfo>& Index() const { return index_; }
+
+   private:
+    std::ifstream trace_file_;
+    std::vector<BlockInfo> index_;
+    size_t next_block_ = 0;
+    std::vector<unsigned char> block_;
+    size_t pos_ = 0;
+    uint32_t records_left_ = 0;
+    uint64_t addr_ = 0;
+    uint64_t cycle_ = 0;
+    bool ReadBlock();
+};
+
+// parses ahead of the simulation: a background thread moves the
+// requests of another reader into a lock-free single-producer
+// single-consumer ring, Next only pops them
+class PrefetchTraceReader : public TraceReader {
+   public:
+    static const size_t kRingSize = 1 << 16;  // power of 2
+
+    PrefetchTraceReader(TraceReader* reader);  // takes ownership
+    ~PrefetchTraceReader();
+    bool Next(Transaction& trans) override;
+
+   private:
+    TraceReader* reader_;
+    std::vector<Transaction> ring_;
+    // slots [head_, tail_) are ready, both only grow; padded to keep the
+    // consumer and producer counters on cache lines of their own (not
+    // alignas, which needs aligned new for the heap allocated reader)
+    char pad0_[64];
+    std::atomic<uint64_t> head_;
+    char pad1_[64 - sizeof(std::atomic<uint64_t>)];
+    std::atomic<uint64_t> tail_;
+    char pad2_[64 - sizeof(std::atomic<uint64_t>)];
+    std::atomic<bool> done_;
+    std::atomic<bool> stop_;
+    std::thread thread_;
+    void Produce();
+};
+
+// sink of trace requests in one of the formats above, flushed and closed
+// when deleted
+class TraceWriter {
+   public:
+    virtual ~TraceWriter() {}
+    virtual void Write(const Transaction& trans) = 0;
+};
+
+class TextTraceWriter : public TraceWriter {
+   public:
+    TextTraceWriter(const std::string& trace_file);
+    void Write(const Transaction& trans) override;
+
+   private:
+    std::ofstream trace_file_;
+};
+
+class BinaryTraceWriter : public TraceWriter {
+   public:
+    BinaryTraceWriter(const std::string& trace_file);
+    ~BinaryTraceWriter();
+    void Write(const Transaction& trans) override;
+
+   private:
+    std::ofstream trace_file_;
+    std::vector<unsigned char> buffer_;
+    uint64_t cycle_ = 0;
+    void Put(uint64_t addr, uint32_t word);
+};
+
+class CompressedTraceWriter : public TraceWriter {
+   public:
+    CompressedTraceWriter(const std::string& trace_file);
+    ~CompressedTraceWriter();
+    void Write(const Transaction& trans) override;
+
+   private:
+    std::ofstream trace_file_;
+    std::vector<CompressedTraceReader::BlockInfo> index_;
+    std::vector<unsigned char> block_;
+    uint32_t block_records_ = 0;
+    uint64_t offset_;
+    uint64_t num_trans_ = 0;
+    uint64_t addr_ = 0;
+    uint64_t cycle_ = 0;
+    void FlushBlock();
+};
+
+// "text", "binary" or "compressed", from the file contents
+std::string GetTraceFormat(const std::string& trace_file);
+
+// picks the reader from the file contents, prefetching on a thread of
+// its own if asked to
+TraceReader* GetTraceReader(const std::string& trace_file,
+                            bool prefetch = false);
+
+TraceWriter* GetTraceWriter(const std::string& trace_file,
+                            const std::string& format);
+
+// writes the requests of any trace in the given format, returns the
+// number of requests
+uint64_t ConvertTrace(const std::string& trace_file,
+                      const std::string& new_trace_file,
+                      const std::string& format);
+
+}  // namespace dramsim3
+#endif
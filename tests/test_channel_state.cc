@@ -0,0 +1,113 @@
+#include "catch.hpp"
+#include "channel_state.h"
+
+using dramsim3::Address;
+using dramsim3::Command;
+using dramsim3::CommandType;
+
+TEST_CASE("Neighbor activations as ROW_REFRESH", "[channel_state]") {
+    dramsim3::Config config("configs/DDR4_8Gb_x8_2400.ini", ".");
+    dramsim3::Timing timing(config);
+    dramsim3::ChannelState channel_state(config, timing);
+    Address victim(0, 0, 0, 0, 10, 0);
+    Command row_refresh(CommandType::ROW_REFRESH, victim, 0);
+
+    SECTION("TEST closed bank") {
+        auto cmd = channel_state.GetReadyCommand(row_refresh, 0);
+        REQUIRE(cmd.cmd_type == CommandType::ROW_REFRESH);
+        channel_state.UpdateTimingAndStates(cmd, 0);
+        // the bank closes itself, the next ACT waits for tRC
+        REQUIRE(!channel_state.IsRowOpen(0, 0, 0));
+        Command read(CommandType::READ, victim, 0);
+        REQUIRE(!channel_state.GetReadyCommand(read, config.tRC - 1).IsValid());
+        REQUIRE(channel_state.GetReadyCommand(read, config.tRC).cmd_type ==
+                CommandType::ACTIVATE);
+    }
+
+    SECTION("TEST open bank") {
+        Address open(victim);
+        open.row = 20;
+        channel_state.UpdateTimingAndStates(
+            Command(CommandType::ACTIVATE, open, 0), 0);
+        auto cmd = channel_state.GetReadyCommand(row_refresh, config.tRAS);
+        REQUIRE(cmd.cmd_type == CommandType::PRECHARGE);
+    }
+
+    SECTION("TEST counted in tFAW") {
+        for (int bank = 0; bank < 4; bank++) {
+            Address addr(0, 0, bank % config.bankgroups, bank / 2, 10, 0);
+            channel_state.UpdateTimingAndStates(
+                Command(CommandType::ROW_REFRESH, addr, 0), 0);
+        }
+        REQUIRE(!channel_state.ActivationWindowOk(0, config.tFAW - 1));
+        REQUIRE(channel_state.ActivationWindowOk(0, config.tFAW));
+    }
+}
+
+TEST_CASE("Refresh management", "[channel_state]") {
+    dramsim3::Config config("configs/DDR4_8Gb_x8_2400.ini", ".");
+    config.rfm = true;
+    config.raaimt = 4;
+    config.raammt = 8;
+    config.rfm_postpone = true;
+    dramsim3::Timing timing(config);
+    dramsim3::ChannelState channel_state(config, timing);
+    Address addr(0, 0, 0, 0, 10, 0);
+    auto activate = [&](int n) {
+        for (int i = 0; i < n; i++) {
+            channel_state.UpdateTimingAndStates(
+                Command(CommandType::ACTIVATE, addr, 0), 0);
+            channel_state.UpdateTimingAndStates(
+                Command(CommandType::PRECHARGE, addr, 0), 0);
+        }
+    };
+
+    SECTION("TEST postponed until RAAMMT") {
+        activate(3);
+        REQUIRE(channel_state.PostponedRFMs().empty());
+        activate(1);
+        REQUIRE(channel_state.PostponedRFMs().size() == 1);
+        REQUIRE(!channel_state.IsRefreshWaiting());
+        activate(4);
+        REQUIRE(channel_state.IsRefreshWaiting());
+        REQUIRE(channel_state.PendingRefCommand().cmd_type == CommandType::RFM);
+        REQUIRE(channel_state.PendingRefCommand().Bank() == 0);
+        REQUIRE(channel_state.PostponedRFMs().empty());
+    }
+
+    SECTION("TEST RFM and REF decrease RAA") {
+        activate(8);
+        Command rfm(channel_state.PendingRefCommand());
+        channel_state.UpdateTimingAndStates(rfm, 0);
+        // 4 left, still at RAAIMT
+        REQUIRE(!channel_state.IsRefreshWaiting());
+        REQUIRE(channel_state.PostponedRFMs().size() == 1);
+        channel_state.UpdateTimingAndStates(
+            Command(CommandType::REFRESH, Address(0, 0, -1, -1, -1, -1), 0),
+            0);
+        REQUIRE(channel_state.PostponedRFMs().empty());
+    }
+
+    SECTION("TEST no postponing") {
+        config.rfm_postpone = false;
+        activate(4);
+        REQUIRE(channel_state.IsRefreshWaiting());
+        REQUIRE(channel_state.PostponedRFMs().empty());
+    }
+}
+
+TEST_CASE("Bank RAA count", "[channel_state]") {
+    dramsim3::BankState bank_state;
+    Address addr(0, 0, 0, 0, 10, 0);
+    for (int i = 0; i < 3; i++) {
+        bank_state.UpdateState(Command(CommandType::ACTIVATE, addr, 0));
+        bank_state.UpdateState(Command(CommandType::PRECHARGE, addr, 0));
+    }
+    // victim refreshes are not activations of the bank
+    bank_state.UpdateState(Command(CommandType::ROW_REFRESH, addr, 0));
+    REQUIRE(bank_state.RAACount() == 3);
+    bank_state.DecreaseRAA(2);
+    REQUIRE(bank_state.RAACount() == 1);
+    bank_state.DecreaseRAA(2);
+    REQUIRE(bank_state.RAACount() == 0);
+}
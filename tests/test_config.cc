@@ -91,5 +91,20 @@ TEST_CASE("Address Mapping", "[config]") {
         addr = config.AddressMapping(hex_addr);
         REQUIRE(addr.row == 0b10000000000000);
     }
-}
 
+    SECTION("Test address inverse mapping") {
+        uint64_t hex_addr = 0b10001111111111111111111;
+        auto addr = config.AddressMapping(hex_addr);
+        // the lowest shift_bits are lost in the mapping
+        REQUIRE(config.AddressInverseMapping(addr) ==
+                (hex_addr >> config.shift_bits) << config.shift_bits);
+
+        addr = dramsim3::Address(5, 0, 2, 2, 17, 31);
+        auto inv_addr = config.AddressMapping(config.AddressInverseMapping(addr));
+        REQUIRE(inv_addr.channel == 5);
+        REQUIRE(inv_addr.bankgroup == 2);
+        REQUIRE(inv_addr.bank == 2);
+        REQUIRE(inv_addr.row == 17);
+        REQUIRE(inv_addr.column == 31);
+    }
+}
@@ -0,0 +1,78 @@
+#include <vector>
+#include "catch.hpp"
+#include "command_queue.h"
+#include "controller.h"
+
+using dramsim3::Address;
+using dramsim3::Command;
+using dramsim3::CommandType;
+
+TEST_CASE("Mitigation bursts ahead of requests", "[controller]") {
+    dramsim3::Config config("configs/DDR4_8Gb_x8_2400.ini", ".");
+    config.output_level = -1;
+    config.rowhammer_scheme = "PRA";
+    config.pra_probability = 1.0;
+    dramsim3::Timing timing(config);
+    dramsim3::Controller controller(0, config, timing);
+    auto hex_addr = [&](int row) {
+        return config.AddressInverseMapping(Address(0, 0, 0, 0, row, 0));
+    };
+    // all in the command queue before the first ACT
+    for (int row : {10, 20, 30}) {
+        controller.AddTransaction(dramsim3::Transaction(hex_addr(row), false));
+    }
+    // neighbor activations issued by the time each read returned
+    std::vector<double> nei_acts;
+    for (uint64_t clk = 0; clk < 2000 && nei_acts.size() < 3; clk++) {
+        while (controller.ReturnDoneTrans(clk).second == 0) {
+            // counters are only totalled at the end of an epoch
+            controller.PrintEpochStats();
+            nei_acts.push_back(controller.GetStat("num_NEI_ACT_cmds"));
+        }
+        controller.ClockTick();
+    }
+    REQUIRE(nei_acts.size() == 3);
+    // the neighbors of row 10 are refreshed before row 20 is activated,
+    // and those of row 20 before row 30
+    REQUIRE(nei_acts[1] >= 2);
+    REQUIRE(nei_acts[2] >= 4);
+}
+
+TEST_CASE("Held activations", "[controller]") {
+    dramsim3::Config config("configs/DDR4_8Gb_x8_2400.ini", ".");
+    dramsim3::Timing timing(config);
+    dramsim3::ChannelState channel_state(config, timing);
+    dramsim3::SimpleStats stats(config, 0);
+    dramsim3::CommandQueue cmd_queue(0, config, channel_state, stats);
+    bool hold = true;
+    cmd_queue.SetActivationHold([&hold](const Command&) { return hold; });
+    Address addr(0, 0, 0, 0, 10, 0);
+    cmd_queue.AddCommand(Command(CommandType::READ, addr, 0));
+    REQUIRE(!cmd_queue.GetCommandToIssue().IsValid());
+    hold = false;
+    REQUIRE(cmd_queue.GetCommandToIssue().cmd_type == CommandType::ACTIVATE);
+}
+
+TEST_CASE("TRR victims refreshed within REF", "[controller]") {
+    dramsim3::Config config("configs/DDR4_8Gb_x8_2400.ini", ".");
+    config.output_level = -1;
+    config.trr_entries = 1;
+    dramsim3::Timing timing(config);
+    dramsim3::Controller controller(0, config, timing);
+    Address aggressor(0, 0, 0, 0, 10, 0);
+    controller.AddTransaction(
+        dramsim3::Transaction(config.AddressInverseMapping(aggressor), false));
+    // the rank gets at least one REF, the only aggressor is taken by the
+    // first one
+    for (uint64_t clk = 0; clk < 2 * static_cast<uint64_t>(config.tREFI);
+         clk++) {
+        controller.ReturnDoneTrans(clk);
+        controller.ClockTick();
+    }
+    controller.PrintEpochStats();
+    REQUIRE(controller.GetStat("num_ref_cmds") >= 1);
+    REQUIRE(controller.GetStat("num_trr_refreshes") == 1);
+    REQUIRE(controller.GetStat("num_trr_victim_refreshes") == 2);
+    // no command of their own
+    REQUIRE(controller.GetStat("num_NEI_ACT_cmds") == 0);
+}
@@ -0,0 +1,332 @@
+#include <cstdio>
+#include <fstream>
+#include <numeric>
+#include <random>
+#include "catch.hpp"
+#include "cpu.h"
+#include "json.hpp"
+#include "sweep.h"
+
+namespace {
+// exposes the channel stats of the memory system
+template <class BaseCPU>
+class StatsCPU : public BaseCPU {
+   public:
+    using BaseCPU::BaseCPU;
+    double Sum(const std::string& name) const {
+        auto stats = this->memory_system_.GetChannelStats(name);
+        return std::accumulate(stats.begin(), stats.end(), 0.0);
+    }
+};
+}  // namespace
+
+TEST_CASE("HammerCPU attack patterns", "[cpu]") {
+    dramsim3::Config config("configs/DDR4_8Gb_x8_2400.ini", ".");
+    config.output_level = 0;
+    config.json_stats_name = "test_hammer.json";
+    config.hammer_interval = 100;
+    const uint64_t cycles = 100000;
+    // stats of the only channel
+    auto run = [&](dramsim3::CPU& cpu) {
+        for (uint64_t clk = 0; clk < cycles; clk++) {
+            cpu.ClockTick();
+        }
+        cpu.PrintStats();
+        std::ifstream stats_file(config.json_stats_name);
+        nlohmann::json stats;
+        stats_file >> stats;
+        std::remove(config.json_stats_name.c_str());
+        return stats["0"];
+    };
+
+    SECTION("TEST aggressor reads miss the row buffer") {
+        for (auto pattern : {"SINGLE", "DOUBLE", "MANY"}) {
+            config.hammer_pattern = pattern;
+            config.hammer_aggressors = 4;
+            dramsim3::HammerCPU cpu(config, ".");
+            auto stats = run(cpu);
+            // one read every interval, unless held up by a REF
+            REQUIRE(stats["num_reads_done"] <= cycles / 100);
+            REQUIRE(stats["num_reads_done"] >= cycles / 100 - 2);
+            REQUIRE(stats["num_writes_done"] == 0);
+            // the aggressors close each other's rows, reads merged into a
+            // pending one while a REF blocks the bank issue no command
+            REQUIRE(stats["num_read_row_hits"].get<double>() * 10 <
+                    stats["num_read_cmds"].get<double>());
+        }
+    }
+
+    SECTION("TEST benign traffic in between") {
+        config.hammer_benign = "RANDOM";
+        config.hammer_benign_ratio = 0.1;
+        dramsim3::HammerCPU cpu(config, ".");
+        auto stats = run(cpu);
+        REQUIRE(stats["num_reads_done"].get<double>() +
+                    stats["num_writes_done"].get<double>() >
+                cycles / 100 * 2);
+    }
+}
+
+TEST_CASE("Lockstep co-simulation", "[cpu]") {
+    dramsim3::Config config("configs/DDR4_8Gb_x8_2400.ini", ".");
+    config.output_level = -1;
+    // a few hot rows among random ones
+    const std::string trace_file = "test_lockstep.trace";
+    {
+        std::ofstream trace(trace_file);
+        std::mt19937_64 gen(1);
+        for (int i = 0; i < 5000; i++) {
+            uint64_t addr = i % 4 == 0 ? (gen() % 4) << 20 : gen() >> 30;
+            trace << "0x" << std::hex << addr << std::dec
+                  << (i % 3 == 0 ? " WRITE " : " READ ") << i * 4 << "\n";
+        }
+    }
+    dramsim3::Config cra_config(config);
+    cra_config.rowhammer_scheme = "CRA";
+    cra_config.cra_threshold = 8;
+    auto run = [&](const std::vector<dramsim3::Config>& configs,
+                   const std::vector<std::string>& labels) {
+        StatsCPU<dramsim3::LockstepTraceCPU> cpu(configs, labels, ".",
+                                                 trace_file);
+        for (int clk = 0; clk < 40000; clk++) {
+            cpu.ClockTick();
+        }
+        cpu.PrintStats();
+        std::vector<double> stats;
+        for (auto name : {"num_reads_done", "num_writes_done", "num_act_cmds",
+                          "num_NEI_ACT_cmds", "average_read_latency",
+                          "total_energy"}) {
+            stats.push_back(cpu.Sum(name));
+        }
+        return stats;
+    };
+
+    // every system sees the trace as if it ran alone
+    auto baseline = run({config, cra_config}, {"X", "CRA"});
+    REQUIRE(run({config}, {"X"}) == baseline);
+    auto mitigated = run({cra_config, config}, {"CRA", "X"});
+    REQUIRE(run({cra_config}, {"CRA"}) == mitigated);
+    REQUIRE(baseline[3] == 0);
+    REQUIRE(mitigated[3] > 0);
+    REQUIRE(mitigated[0] + mitigated[1] == baseline[0] + baseline[1]);
+    std::remove(trace_file.c_str());
+}
+
+TEST_CASE("Parameter sweep", "[cpu]") {
+    SECTION("TEST ranges include both ends") {
+        auto values = dramsim3::SweepRange("0.001:0.01:10");
+        REQUIRE(values.size() == 10);
+        REQUIRE(values.front() == Approx(0.001));
+        REQUIRE(values[1] == Approx(0.002));
+        REQUIRE(values.back() == Approx(0.01));
+        REQUIRE(dramsim3::SweepRange("5:9:1") == std::vector<double>{5});
+    }
+
+    SECTION("TEST workers give the results of a serial run") {
+        dramsim3::Config config("configs/DDR4_8Gb_x8_2400.ini", ".");
+        config.output_level = -1;
+        config.output_prefix = "test_sweep_";
+        const std::string trace_file = "test_sweep.trace";
+        {
+            std::ofstream trace(trace_file);
+            std::mt19937_64 gen(1);
+            for (int i = 0; i < 3000; i++) {
+                uint64_t addr = i % 4 == 0 ? (gen() % 4) << 20 : gen() >> 30;
+                trace << "0x" << std::hex << addr << std::dec
+                      << (i % 3 == 0 ? " WRITE " : " READ ") << i * 4
+                      << "\n";
+            }
+        }
+        std::vector<dramsim3::SweepPoint> points = {
+            {"CRA", 4}, {"CRA", 1000}, {"PRA", 0.5}};
+        auto sweep = [&](int num_threads) {
+            dramsim3::RunSweep(config, points, ".", trace_file, 20000,
+                               num_threads);
+            std::ifstream table_file(config.output_prefix + "sweep.json");
+            nlohmann::json table;
+            table_file >> table;
+            return table;
+        };
+        auto table = sweep(1);
+        REQUIRE(table.size() == points.size());
+        REQUIRE(sweep(3) == table);
+        REQUIRE(table[0]["label"] == "CRA_4");
+        REQUIRE(table[0]["num_NEI_ACT_cmds"] > table[1]["num_NEI_ACT_cmds"]);
+        REQUIRE(table[2]["num_NEI_ACT_cmds"] > 0);
+        for (const auto& row : table) {
+            std::string name =
+                config.output_prefix + "_" + row["label"].get<std::string>();
+            std::remove((name + ".json").c_str());
+        }
+        std::remove((config.output_prefix + "sweep.json").c_str());
+        std::remove(trace_file.c_str());
+    }
+
+    SECTION("TEST thresholds rounded and run once") {
+        dramsim3::Config config("configs/DDR4_8Gb_x8_2400.ini", ".");
+        config.output_level = -1;
+        config.output_prefix = "test_sweep_";
+        const std::string trace_file = "test_sweep.trace";
+        {
+            std::ofstream trace(trace_file);
+            for (int i = 0; i < 100; i++) {
+                trace << "0x" << std::hex << (i % 2) * (1 << 20) << std::dec
+                      << " READ " << i * 4 << "\n";
+            }
+        }
+        std::vector<dramsim3::SweepPoint> points = {
+            {"CRA", 10.2}, {"CRA", 9.8}, {"CRA", 10.4}, {"PRA", 0.5}};
+        dramsim3::RunSweep(config, points, ".", trace_file, 2000, 1);
+        std::ifstream table_file(config.output_prefix + "sweep.json");
+        nlohmann::json table;
+        table_file >> table;
+        REQUIRE(table.size() == 2);
+        REQUIRE(table[0]["label"] == "CRA_10");
+        REQUIRE(table[1]["label"] == "PRA_0.5");
+        for (const auto& row : table) {
+            std::string name =
+                config.output_prefix + "_" + row["label"].get<std::string>();
+            std::remove((name + ".json").c_str());
+        }
+        std::remove((config.output_prefix + "sweep.json").c_str());
+        std::remove(trace_file.c_str());
+    }
+}
+
+TEST_CASE("MultiTraceCPU per-core stats", "[cpu]") {
+    dramsim3::Config config("configs/DDR4_8Gb_x8_2400.ini", ".");
+    config.output_level = -1;
+    config.output_prefix = "test_multi_";
+    // core i issues 500 * (i + 1) requests to addresses of its own,
+    // every third one a write
+    std::vector<std::string> trace_files;
+    uint64_t num_trans = 0;
+    for (int i = 0; i < 3; i++) {
+        trace_files.push_back("test_core" + std::to_string(i) + ".trace");
+        std::ofstream trace(trace_files.back());
+        for (int j = 0; j < 500 * (i + 1); j++) {
+            uint64_t addr = (static_cast<uint64_t>(i) << 28) + j * 4096;
+            trace << "0x" << std::hex << addr << std::dec
+                  << (j % 3 == 0 ? " WRITE " : " READ ") << j * (i + 2)
+                  << "\n";
+            num_trans++;
+        }
+    }
+    {
+        dramsim3::MultiTraceCPU cpu(config, ".", trace_files);
+        for (int clk = 0; clk < 100000; clk++) {
+            cpu.ClockTick();
+        }
+        cpu.PrintStats();
+        REQUIRE(cpu.Summary().reqs_done == num_trans);
+    }
+
+    std::ifstream cores_file(config.output_prefix + "cores.json");
+    nlohmann::json cores;
+    cores_file >> cores;
+    REQUIRE(cores.size() == 3);
+    uint64_t issued = 0, done = 0;
+    for (int i = 0; i < 3; i++) {
+        const auto& core = cores[i];
+        REQUIRE(core["trace"] == trace_files[i]);
+        REQUIRE(core["reqs_issued"] == 500 * (i + 1));
+        // all returned to the core that issued them
+        REQUIRE(core["num_writes_done"] == (500 * (i + 1) + 2) / 3);
+        issued += core["reqs_issued"].get<uint64_t>();
+        done += core["num_reads_done"].get<uint64_t>() +
+                core["num_writes_done"].get<uint64_t>();
+    }
+    REQUIRE(issued == num_trans);
+    REQUIRE(done == num_trans);
+    std::remove((config.output_prefix + "cores.json").c_str());
+    for (const auto& trace_file : trace_files) {
+        std::remove(trace_file.c_str());
+    }
+}
+
+TEST_CASE("MultiTraceCPU cores sharing an address", "[cpu]") {
+    dramsim3::Config config("configs/DDR4_8Gb_x8_2400.ini", ".");
+    config.output_level = -1;
+    config.output_prefix = "test_shared_";
+    // core 1 reads the address core 0 is reading from DRAM, its read is
+    // served by its own write still in the write buffer and returns first
+    std::vector<std::string> trace_files = {"test_shared0.trace",
+                                            "test_shared1.trace"};
+    {
+        std::ofstream trace(trace_files[0]);
+        trace << "0x1000 READ 0\n";
+    }
+    {
+        std::ofstream trace(trace_files[1]);
+        trace << "0x1000 WRITE 1\n0x1000 READ 2\n";
+    }
+    {
+        dramsim3::MultiTraceCPU cpu(config, ".", trace_files);
+        for (int clk = 0; clk < 1000; clk++) {
+            cpu.ClockTick();
+        }
+        cpu.PrintStats();
+    }
+
+    std::ifstream cores_file(config.output_prefix + "cores.json");
+    nlohmann::json cores;
+    cores_file >> cores;
+    REQUIRE(cores.size() == 2);
+    REQUIRE(cores[0]["num_reads_done"] == 1);
+    REQUIRE(cores[1]["num_reads_done"] == 1);
+    REQUIRE(cores[1]["num_writes_done"] == 1);
+    // each read is timed from the issue of its own core
+    REQUIRE(cores[1]["average_read_latency"].get<double>() <= 2);
+    REQUIRE(cores[0]["average_read_latency"].get<double>() > 2);
+    std::remove((config.output_prefix + "cores.json").c_str());
+    for (const auto& trace_file : trace_files) {
+        std::remove(trace_file.c_str());
+    }
+}
+
+TEST_CASE("Fast forward", "[cpu]") {
+    dramsim3::Config config("configs/DDR4_8Gb_x8_2400.ini", ".");
+    config.output_level = -1;
+    // bursts of requests with idle gaps of several refresh intervals
+    const std::string trace_file = "test_sparse.trace";
+    {
+        std::ofstream trace(trace_file);
+        for (int burst = 0; burst < 20; burst++) {
+            for (int j = 0; j < 50; j++) {
+                uint64_t addr = (burst * 7919 + j * 104729) * 64ull;
+                trace << "0x" << std::hex << addr << std::dec
+                      << (j % 4 == 0 ? " WRITE " : " READ ")
+                      << burst * 50000 + j * 3 << "\n";
+            }
+        }
+    }
+    const uint64_t cycles = 1000000;
+    auto run = [&](dramsim3::CPU& cpu, bool fast_forward) {
+        uint64_t skipped = 0;
+        for (uint64_t clk = 0; clk < cycles; clk++) {
+            if (fast_forward) {
+                uint64_t skip = cpu.FastForward(cycles - clk - 1);
+                clk += skip;
+                skipped += skip;
+            }
+            cpu.ClockTick();
+        }
+        cpu.PrintStats();
+        return skipped;
+    };
+
+    StatsCPU<dramsim3::TraceBasedCPU> ticked(config, ".", trace_file);
+    REQUIRE(run(ticked, false) == 0);
+    StatsCPU<dramsim3::TraceBasedCPU> skipped(config, ".", trace_file);
+    // most of the run is idle
+    REQUIRE(run(skipped, true) > cycles / 2);
+    for (auto name : {"num_cycles", "num_reads_done", "num_writes_done",
+                      "average_read_latency", "num_act_cmds", "num_pre_cmds",
+                      "num_ref_cmds", "num_read_row_hits", "total_energy"}) {
+        INFO(name);
+        REQUIRE(skipped.Sum(name) == Approx(ticked.Sum(name)));
+    }
+    REQUIRE(ticked.Sum("num_reads_done") + ticked.Sum("num_writes_done") ==
+            1000);
+    std::remove(trace_file.c_str());
+}
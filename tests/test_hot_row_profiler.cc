@@ -0,0 +1,69 @@
+#include <algorithm>
+#include <map>
+#include <random>
+#include "catch.hpp"
+#include "hot_row_profiler.h"
+
+TEST_CASE("Hot row profiler", "[hot_rows]") {
+    dramsim3::Config config("configs/DDR4_8Gb_x8_2400.ini", ".");
+    config.hot_rows = 64;
+    auto row = [](int r) { return dramsim3::Address(0, 0, 0, 0, r, 0); };
+    // rows 0..49, row r activated about 2 * (50 - r) times
+    std::mt19937 gen(1);
+    std::vector<int> activations;
+    for (int r = 0; r < 50; r++) {
+        for (int i = 0; i < 2 * (50 - r); i++) {
+            activations.push_back(r);
+        }
+    }
+    std::shuffle(activations.begin(), activations.end(), gen);
+    std::map<int, uint32_t> actual;
+    for (int r : activations) {
+        actual[r]++;
+    }
+
+    SECTION("TEST never underestimates") {
+        // far fewer counters than rows, most of them collide
+        config.hot_rows_sketch_width = 8;
+        config.hot_rows_sketch_depth = 2;
+        dramsim3::HotRowProfiler profiler(config);
+        for (int r : activations) {
+            profiler.AddActivation(row(r));
+        }
+        auto rows = profiler.ToJson()["0.0.0"];
+        REQUIRE(rows.size() == 50);
+        for (const auto& hot : rows) {
+            REQUIRE(hot[1].get<uint32_t>() >= actual[hot[0].get<int>()]);
+        }
+    }
+
+    SECTION("TEST top rows, hottest first") {
+        config.hot_rows = 5;
+        dramsim3::HotRowProfiler profiler(config);
+        for (int r : activations) {
+            profiler.AddActivation(row(r));
+        }
+        // another bank is reported on its own
+        profiler.AddActivation(dramsim3::Address(0, 0, 1, 2, 7, 0));
+        auto banks = profiler.ToJson();
+        REQUIRE(banks.size() == 2);
+        REQUIRE(banks["0.1.2"][0][0] == 7);
+        auto rows = banks["0.0.0"];
+        REQUIRE(rows.size() == 5);
+        for (int i = 0; i < 5; i++) {
+            REQUIRE(rows[i][0] == i);
+            REQUIRE(rows[i][1] == actual[i]);
+        }
+        profiler.Reset();
+        REQUIRE(profiler.ToJson().empty());
+    }
+
+    SECTION("TEST disabled") {
+        config.hot_rows = 0;
+        dramsim3::HotRowProfiler profiler(config);
+        for (int r : activations) {
+            profiler.AddActivation(row(r));
+        }
+        REQUIRE(profiler.ToJson().empty());
+    }
+}
@@ -0,0 +1,604 @@
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <random>
+#include <sstream>
+#include "catch.hpp"
+#include "json.hpp"
+#include "rowhammer.h"
+
+TEST_CASE("Row counter table", "[rowhammer]") {
+    SECTION("TEST narrowest entries") {
+        REQUIRE(dramsim3::RowCounterTable(100, UINT8_MAX).bytes() == 100);
+        REQUIRE(dramsim3::RowCounterTable(100, UINT8_MAX + 1).bytes() == 200);
+        REQUIRE(dramsim3::RowCounterTable(100, UINT16_MAX + 1).bytes() == 400);
+    }
+
+    SECTION("TEST saturating counts") {
+        dramsim3::RowCounterTable table(10, 300);
+        table.set(3, 1000);
+        REQUIRE(table.get(3) == 300);
+        table.set(3, 7);
+        REQUIRE(table.get(3) == 7);
+        REQUIRE(table.get(2) == 0);
+        REQUIRE(table.get(4) == 0);
+    }
+}
+
+TEST_CASE("Sparse row counter table", "[rowhammer]") {
+    // same contents as the dense table, through several grows
+    dramsim3::RowCounterTable dense(1 << 20, 1000);
+    dramsim3::SparseRowCounterTable sparse(1000);
+    size_t initial_bytes = sparse.bytes();
+    std::mt19937_64 gen(1);
+    for (int i = 0; i < 20000; i++) {
+        uint64_t row_id = gen() % (1 << 20);
+        uint32_t count = gen() % 1200;
+        dense.set(row_id, count);
+        sparse.set(row_id, count);
+    }
+    bool same = true;
+    for (uint64_t row_id = 0; row_id < (1 << 20); row_id++) {
+        same = same && dense.get(row_id) == sparse.get(row_id);
+    }
+    REQUIRE(same);
+    REQUIRE(sparse.bytes() > initial_bytes);
+    REQUIRE(sparse.bytes() < dense.bytes() * 2);
+
+    SECTION("TEST zero counts take no entry") {
+        dramsim3::SparseRowCounterTable empty(1000);
+        for (uint64_t row_id = 0; row_id < 10000; row_id++) {
+            empty.set(row_id, 0);
+        }
+        REQUIRE(empty.bytes() == initial_bytes);
+    }
+}
+
+TEST_CASE("CRA threshold", "[rowhammer]") {
+    dramsim3::Config config("configs/DDR4_8Gb_x8_2400.ini", ".");
+    auto row = [](int bank, int r) {
+        return dramsim3::Address(0, 0, 0, bank, r, 0);
+    };
+    for (auto tracker : {"dense", "sparse"}) {
+        config.cra_tracker = tracker;
+        dramsim3::CRA cra(config, 4);
+        auto activate = [&](const dramsim3::Address& addr) {
+            cra.updateInfo(addr, 0);
+            return cra.isInsertionRequired();
+        };
+        for (int i = 0; i < 3; i++) {
+            REQUIRE(!activate(row(0, 10)));
+        }
+        // the same row of another bank has a counter of its own
+        REQUIRE(!activate(row(1, 10)));
+        REQUIRE(cra.counterFunc(row(1, 10)) == 1);
+        REQUIRE(activate(row(0, 10)));
+        // counted from 0 again after its neighbors were activated
+        for (int i = 0; i < 3; i++) {
+            REQUIRE(!activate(row(0, 10)));
+        }
+        REQUIRE(activate(row(0, 10)));
+        REQUIRE(cra.counterFunc(row(0, 11)) == 0);
+    }
+}
+
+TEST_CASE("CRA counter cache", "[rowhammer]") {
+    // a single set of 2 ways
+    dramsim3::CounterCache cache(1, 2, "LRU");
+    uint64_t evicted = 0;
+    bool evicted_dirty = false;
+
+    SECTION("TEST hit and miss") {
+        REQUIRE(!cache.access(0, false, evicted, evicted_dirty));
+        REQUIRE(!evicted_dirty);
+        REQUIRE(cache.access(0, false, evicted, evicted_dirty));
+        REQUIRE(!cache.access(1, false, evicted, evicted_dirty));
+        REQUIRE(!evicted_dirty);
+        REQUIRE(cache.access(0, false, evicted, evicted_dirty));
+        REQUIRE(cache.access(1, false, evicted, evicted_dirty));
+    }
+
+    SECTION("TEST dirty write back") {
+        REQUIRE(!cache.access(0, true, evicted, evicted_dirty));
+        REQUIRE(!cache.access(1, false, evicted, evicted_dirty));
+        // 1 is the least recently used, it is clean
+        REQUIRE(cache.access(0, false, evicted, evicted_dirty));
+        REQUIRE(!cache.access(2, false, evicted, evicted_dirty));
+        REQUIRE(evicted == 1);
+        REQUIRE(!evicted_dirty);
+        // then 0, written before
+        REQUIRE(!cache.access(3, false, evicted, evicted_dirty));
+        REQUIRE(evicted == 0);
+        REQUIRE(evicted_dirty);
+        // a write hit dirties a clean line
+        REQUIRE(cache.access(2, true, evicted, evicted_dirty));
+        REQUIRE(!cache.access(4, false, evicted, evicted_dirty));
+        REQUIRE(evicted == 3);
+        REQUIRE(!evicted_dirty);
+        REQUIRE(!cache.access(5, false, evicted, evicted_dirty));
+        REQUIRE(evicted == 2);
+        REQUIRE(evicted_dirty);
+    }
+
+    SECTION("TEST counter lines of packed entries") {
+        dramsim3::Config config("configs/DDR4_8Gb_x8_2400.ini", ".");
+        config.cra_cache_sets = 1;
+        config.cra_cache_ways = 1;
+        config.cra_counters_per_line = config.request_size_bytes;
+        dramsim3::Address addr(0, 0, 0, 0, 10, 0);
+        // a threshold of 4 fits in a byte, with the refresh stamp the
+        // entries take 16 bits
+        config.cra_refresh_reset = false;
+        dramsim3::CRA narrow(config, 4);
+        narrow.updateInfo(addr, 0);
+        REQUIRE(narrow.takeCounterTraffic().size() == 1);
+        config.cra_refresh_reset = true;
+        dramsim3::CRA stamped(config, 4);
+        stamped.updateInfo(addr, 0);
+        REQUIRE(stamped.takeCounterTraffic().size() == 2);
+    }
+}
+
+TEST_CASE("Offline trace conversion", "[rowhammer]") {
+    dramsim3::Config config("configs/DDR4_8Gb_x8_2400.ini", ".");
+    config.rowhammer_scheme = "CRA";
+    config.cra_threshold = 4;
+    // larger than a read block, a few hot rows among random ones
+    const std::string trace_file = "test_convert.trace";
+    const int num_lines = 400000;
+    {
+        std::ofstream trace(trace_file);
+        std::mt19937_64 gen(1);
+        for (int i = 0; i < num_lines; i++) {
+            uint64_t addr = i % 5 == 0 ? (gen() % 8) << 20 : gen() >> 30;
+            trace << "0x" << std::hex << addr << std::dec
+                  << (i % 3 == 0 ? " WRITE " : " READ ") << i << "\n";
+        }
+    }
+    auto convert = [&](int num_threads) {
+        std::string new_trace_file = dramsim3::Rowhammer::convertedTrace(
+            config, trace_file, num_threads);
+        std::ifstream new_trace(new_trace_file);
+        std::stringstream contents;
+        contents << new_trace.rdbuf();
+        std::remove(new_trace_file.c_str());
+        return contents.str();
+    };
+    std::string converted = convert(1);
+    int requests = 0, neighbors = 0;
+    std::istringstream lines(converted);
+    std::string line;
+    while (std::getline(lines, line)) {
+        if (line.find(" NEI_ACT ") != std::string::npos) {
+            neighbors++;
+        } else {
+            requests++;
+        }
+    }
+    REQUIRE(requests == num_lines);
+    REQUIRE(neighbors > 0);
+    // the same output, whatever the number of parsing threads
+    REQUIRE(convert(4) == converted);
+    std::remove(trace_file.c_str());
+}
+
+TEST_CASE("Graphene tracker", "[rowhammer]") {
+    dramsim3::Config config("configs/DDR4_8Gb_x8_2400.ini", ".");
+    // 2 entries per bank, a mitigation every 3 estimated activations
+    dramsim3::Graphene graphene(config, 3, 2);
+    auto row = [](int r) { return dramsim3::Address(0, 0, 0, 0, r, 0); };
+    auto activate = [&](int r) {
+        graphene.updateInfo(row(r), 0);
+        return graphene.isInsertionRequired();
+    };
+
+    SECTION("TEST spill over") {
+        REQUIRE(!activate(1));
+        REQUIRE(!activate(1));
+        REQUIRE(!activate(2));
+        // table full and no count at the spillover, only counted there
+        REQUIRE(!activate(3));
+        // row 2 is at the spillover now, row 3 takes its entry and count
+        REQUIRE(!activate(3));
+        REQUIRE(activate(3));
+        REQUIRE(activate(1));
+        // another bank has a table of its own
+        graphene.updateInfo(dramsim3::Address(0, 0, 0, 1, 1, 0), 0);
+        REQUIRE(!graphene.isInsertionRequired());
+    }
+
+    SECTION("TEST reset every refresh window") {
+        REQUIRE(!activate(1));
+        REQUIRE(!activate(1));
+        dramsim3::Address rank_refresh(0, 0, -1, -1, -1, -1);
+        for (uint64_t i = 1; i < graphene.refreshesPerWindow(); i++) {
+            graphene.updateRefresh(rank_refresh);
+        }
+        REQUIRE(activate(1));
+        REQUIRE(!activate(1));
+        REQUIRE(!activate(1));
+        for (uint64_t i = 0; i < graphene.refreshesPerWindow(); i++) {
+            graphene.updateRefresh(rank_refresh);
+        }
+        REQUIRE(!activate(1));
+        REQUIRE(!activate(1));
+        REQUIRE(activate(1));
+    }
+}
+
+TEST_CASE("TRR sampler", "[rowhammer]") {
+    dramsim3::Config config("configs/DDR4_8Gb_x8_2400.ini", ".");
+    // 2 entries per bank, the neighbors of 2 of them refreshed per REF
+    dramsim3::TRR trr(config, 2, 2, "COUNTER", 1.0);
+    auto row = [](int r) { return dramsim3::Address(0, 0, 0, 0, r, 0); };
+    dramsim3::Address rank_refresh(0, 0, -1, -1, -1, -1);
+
+    SECTION("TEST COUNTER evicts the least activated row") {
+        for (int i = 0; i < 3; i++) {
+            trr.updateInfo(row(1), 0);
+        }
+        trr.updateInfo(row(2), 0);
+        trr.updateInfo(row(3), 0);
+        trr.updateRefresh(rank_refresh);
+        auto aggressors = trr.takeRefreshAggressors();
+        REQUIRE(aggressors.size() == 2);
+        REQUIRE(aggressors[0].row == 1);
+        REQUIRE(aggressors[1].row == 3);
+        // refreshed entries are dropped
+        trr.updateRefresh(rank_refresh);
+        REQUIRE(trr.takeRefreshAggressors().empty());
+    }
+
+    SECTION("TEST hits count up") {
+        trr.updateInfo(row(1), 0);
+        trr.updateInfo(row(2), 0);
+        trr.updateInfo(row(2), 0);
+        trr.updateInfo(row(3), 0);
+        trr.updateInfo(row(3), 0);
+        trr.updateInfo(row(3), 0);
+        // row 1 was the least activated
+        trr.updateRefresh(rank_refresh);
+        auto aggressors = trr.takeRefreshAggressors();
+        REQUIRE(aggressors.size() == 2);
+        REQUIRE(aggressors[0].row == 3);
+        REQUIRE(aggressors[1].row == 2);
+    }
+}
+
+TEST_CASE("Blast radius", "[rowhammer]") {
+    dramsim3::Config config("configs/DDR4_8Gb_x8_2400.ini", ".");
+    config.blast_radius = 2;
+    config.blast_weights = {1.0, 0.5};
+    dramsim3::Rowhammer engine(config);
+    auto rows = [&](int r) {
+        std::vector<int> neighbors;
+        for (const auto& addr :
+             engine.neighborRows(dramsim3::Address(0, 0, 0, 0, r, 0))) {
+            neighbors.push_back(addr.row);
+        }
+        return neighbors;
+    };
+    // distance 2 on every other mitigation, nearest first
+    REQUIRE(rows(10) == std::vector<int>{9, 11});
+    REQUIRE(rows(10) == std::vector<int>{9, 11, 8, 12});
+    REQUIRE(rows(10) == std::vector<int>{9, 11});
+    // clipped at the edges of the bank
+    REQUIRE(rows(0) == std::vector<int>{1, 2});
+    REQUIRE(rows(config.rows - 1) == std::vector<int>{config.rows - 2});
+}
+
+TEST_CASE("Disturbance oracle", "[rowhammer]") {
+    dramsim3::Config config("configs/DDR4_8Gb_x8_2400.ini", ".");
+    config.output_level = -1;
+    dramsim3::SimpleStats stats(config, 0);
+    dramsim3::DisturbanceOracle oracle(config, 4);
+    oracle.setStats(&stats);
+    auto row = [](int r) { return dramsim3::Address(0, 0, 0, 0, r, 0); };
+    for (int i = 0; i < 4; i++) {
+        oracle.updateInfo(row(10), 0);
+    }
+
+    SECTION("TEST hc_first") {
+        REQUIRE(oracle.disturbance(row(9)) == 4);
+        REQUIRE(oracle.disturbance(row(11)) == 4);
+        REQUIRE(oracle.disturbance(row(10)) == 0);
+        oracle.updateInfo(row(10), 0);
+        // an activation restores the row itself
+        oracle.updateInfo(row(9), 0);
+        REQUIRE(oracle.disturbance(row(9)) == 0);
+        REQUIRE(oracle.disturbance(row(11)) == 5);
+        stats.PrintFinalStats();
+        // both victims crossed it once
+        REQUIRE(stats.GetStat("num_hc_first_rows") == 2);
+    }
+
+    SECTION("TEST reset on refresh") {
+        // the n-th refresh of a window covers the n-th slice of rows
+        uint64_t window = oracle.refreshesPerWindow();
+        uint64_t slice = static_cast<uint64_t>(11) * window / config.rows;
+        dramsim3::Address rank_refresh(0, 0, -1, -1, -1, -1);
+        for (uint64_t i = 0; i < slice; i++) {
+            oracle.updateRefresh(rank_refresh);
+        }
+        REQUIRE(oracle.disturbance(row(11)) == 4);
+        oracle.updateRefresh(rank_refresh);
+        REQUIRE(oracle.disturbance(row(11)) == 0);
+        // counted from 0 again
+        oracle.updateInfo(row(10), 0);
+        REQUIRE(oracle.disturbance(row(11)) == 1);
+    }
+
+    SECTION("TEST blast radius") {
+        REQUIRE(oracle.disturbance(row(8)) == 0);
+        config.blast_radius = 2;
+        dramsim3::DisturbanceOracle wide(config, 4);
+        wide.updateInfo(row(10), 0);
+        REQUIRE(wide.disturbance(row(8)) == 1);
+        REQUIRE(wide.disturbance(row(9)) == 1);
+        REQUIRE(wide.disturbance(row(12)) == 1);
+        REQUIRE(wide.disturbance(row(13)) == 0);
+    }
+}
+
+TEST_CASE("BlockHammer throttling", "[rowhammer]") {
+    dramsim3::Config config("configs/DDR4_8Gb_x8_2400.ini", ".");
+    config.output_level = -1;
+    config.blockhammer_blacklist = 4;
+    config.blockhammer_cbf_size = 64;
+    config.blockhammer_delay = 100;
+    dramsim3::SimpleStats stats(config, 0);
+    dramsim3::BlockHammer blockhammer(config);
+    blockhammer.setStats(&stats);
+    auto row = [](int r) { return dramsim3::Address(0, 0, 0, 0, r, 0); };
+    uint64_t clk = 1000;
+    for (int i = 0; i < 3; i++) {
+        REQUIRE(!blockhammer.isActivationDelayed(row(10), clk));
+        blockhammer.updateInfo(row(10), clk);
+        clk += 10;
+    }
+    REQUIRE(!blockhammer.isActivationDelayed(row(10), clk));
+    // blacklisted with this one
+    blockhammer.updateInfo(row(10), clk);
+    uint64_t last = clk;
+
+    SECTION("TEST delayed until the next slot") {
+        REQUIRE(blockhammer.isActivationDelayed(row(10), last + 1));
+        REQUIRE(blockhammer.isActivationDelayed(row(10), last + 99));
+        // another row is not held back
+        REQUIRE(!blockhammer.isActivationDelayed(row(20), last + 1));
+        REQUIRE(!blockhammer.isActivationDelayed(row(10), last + 100));
+        blockhammer.updateInfo(row(10), last + 100);
+        REQUIRE(blockhammer.isActivationDelayed(row(10), last + 101));
+        stats.PrintFinalStats();
+        REQUIRE(stats.GetStat("num_throttled_cycles") == 3);
+    }
+
+    SECTION("TEST blacklist cleared with the epochs") {
+        uint64_t epoch = config.tREFW;
+        // the younger filter still counts the rows of the last epoch
+        blockhammer.updateInfo(row(10), epoch);
+        REQUIRE(blockhammer.isActivationDelayed(row(10), epoch + 1));
+        // and is cleared one epoch later
+        blockhammer.updateInfo(row(10), epoch * 2);
+        REQUIRE(!blockhammer.isActivationDelayed(row(10), epoch * 2 + 1));
+    }
+
+    SECTION("TEST delays per row") {
+        config.output_level = 0;
+        config.json_stats_name = "test_blockhammer.json";
+        auto histogram = [&](const std::string& name) {
+            std::ifstream json_file(config.json_stats_name);
+            std::stringstream channel_stats;
+            channel_stats << "{" << json_file.rdbuf() << "}";
+            return nlohmann::json::parse(channel_stats.str())["0"][name];
+        };
+        REQUIRE(blockhammer.isActivationDelayed(row(10), last + 1));
+        blockhammer.updateInfo(row(10), last + 100);
+        REQUIRE(blockhammer.isActivationDelayed(row(10), last + 150));
+        blockhammer.updateInfo(row(10), last + 200);
+        // held back again, but never issued as a tracked ACT
+        REQUIRE(blockhammer.isActivationDelayed(row(10), last + 201));
+        // two epochs later the wait is forgotten
+        blockhammer.updateInfo(row(10), config.tREFW * 2);
+        blockhammer.finishStats();
+        stats.PrintFinalStats();
+        REQUIRE(histogram("throttle_delay") ==
+                nlohmann::json({{"99", 1}, {"50", 1}}));
+        REQUIRE(histogram("row_throttle_delay") ==
+                nlohmann::json({{"149", 1}}));
+        std::remove(config.json_stats_name.c_str());
+    }
+}
+
+TEST_CASE("PRA random streams", "[rowhammer]") {
+    dramsim3::Config config("configs/DDR4_8Gb_x8_2400.ini", ".");
+    auto bank = [](int b) { return dramsim3::Address(0, 0, 0, b, 10, 0); };
+    auto draws = [&](dramsim3::PRA& pra, int b, int n) {
+        std::vector<bool> selected;
+        for (int i = 0; i < n; i++) {
+            pra.updateInfo(bank(b), 0);
+            selected.push_back(pra.isInsertionRequired());
+        }
+        return selected;
+    };
+
+    SECTION("TEST reproducible and independent per bank") {
+        dramsim3::PRA pra(config, 0.25);
+        dramsim3::PRA other(config, 0.25);
+        auto selected = draws(pra, 0, 1000);
+        // the same seed gives the same draws, whatever the other banks do
+        draws(other, 1, 500);
+        REQUIRE(draws(other, 0, 1000) == selected);
+        REQUIRE(draws(pra, 1, 1000) != selected);
+        int count = 0;
+        for (bool s : selected) count += s;
+        REQUIRE(count > 200);
+        REQUIRE(count < 300);
+        config.rowhammer_seed = 1;
+        dramsim3::PRA reseeded(config, 0.25);
+        REQUIRE(draws(reseeded, 0, 1000) != selected);
+    }
+
+    SECTION("TEST bernoulli thresholds") {
+        REQUIRE(dramsim3::CounterRNG::bernoulliThreshold(0) == 0);
+        REQUIRE(dramsim3::CounterRNG::bernoulliThreshold(1) == UINT64_MAX);
+        REQUIRE(dramsim3::CounterRNG::bernoulliThreshold(0.5) == 1ull << 63);
+        dramsim3::PRA never(config, 0);
+        dramsim3::PRA always(config, 1);
+        auto none = draws(never, 0, 100);
+        auto all = draws(always, 0, 100);
+        REQUIRE(std::count(none.begin(), none.end(), true) == 0);
+        REQUIRE(std::count(all.begin(), all.end(), true) == 100);
+        // nothing activated yet
+        dramsim3::PRA idle(config, 1);
+        REQUIRE(!idle.isInsertionRequired());
+    }
+}
+
+TEST_CASE("CRA refresh reset", "[rowhammer]") {
+    dramsim3::Config config("configs/DDR4_8Gb_x8_2400.ini", ".");
+    auto row = [](int bank, int r) {
+        return dramsim3::Address(0, 0, 0, bank, r, 0);
+    };
+    dramsim3::Address rank_refresh(0, 0, -1, -1, -1, -1);
+    for (auto tracker : {"dense", "sparse"}) {
+        config.cra_tracker = tracker;
+        config.cra_refresh_reset = true;
+        dramsim3::CRA cra(config, 4);
+        auto activate = [&](const dramsim3::Address& addr) {
+            cra.updateInfo(addr, 0);
+            return cra.isInsertionRequired();
+        };
+        for (int i = 0; i < 3; i++) {
+            REQUIRE(!activate(row(0, 11)));
+            REQUIRE(!activate(row(1, 11)));
+        }
+        // the n-th refresh of a window covers the n-th slice of rows
+        uint64_t window = cra.refreshesPerWindow();
+        uint64_t slice = static_cast<uint64_t>(11) * window / config.rows;
+        for (uint64_t i = 0; i < slice; i++) {
+            cra.updateRefresh(rank_refresh);
+        }
+        REQUIRE(cra.counterFunc(row(0, 11)) == 3);
+        // a refresh of another bank leaves the row alone
+        cra.updateRefresh(dramsim3::Address(0, 0, 0, 1, -1, -1));
+        REQUIRE(cra.counterFunc(row(0, 11)) == 3);
+        REQUIRE(cra.counterFunc(row(1, 11)) == 0);
+        cra.updateRefresh(rank_refresh);
+        REQUIRE(cra.counterFunc(row(0, 11)) == 0);
+        // counted from 0 again
+        for (int i = 0; i < 3; i++) {
+            REQUIRE(!activate(row(0, 11)));
+        }
+        REQUIRE(activate(row(0, 11)));
+
+        // a row left alone for several windows starts over too
+        REQUIRE(!activate(row(0, 20)));
+        for (uint64_t i = 0; i < 3 * window; i++) {
+            cra.updateRefresh(rank_refresh);
+        }
+        REQUIRE(cra.counterFunc(row(0, 20)) == 0);
+
+        // and keeps its count without refresh_reset
+        config.cra_refresh_reset = false;
+        dramsim3::CRA no_reset(config, 4);
+        no_reset.updateInfo(row(0, 11), 0);
+        for (uint64_t i = 0; i < window; i++) {
+            no_reset.updateRefresh(rank_refresh);
+        }
+        REQUIRE(no_reset.counterFunc(row(0, 11)) == 1);
+    }
+}
+
+TEST_CASE("RRS row swaps", "[rowhammer]") {
+    dramsim3::Config config("configs/DDR4_8Gb_x8_2400.ini", ".");
+    config.rrs_swap_queue = 2;
+    // a swap every 2 estimated activations of a row
+    dramsim3::RRS rrs(config, 2, 4);
+    auto row = [](int r) { return dramsim3::Address(0, 0, 0, 0, r, 0); };
+    // ACTs go to where the logical row is now
+    auto activate = [&](int r) {
+        auto addr = row(r);
+        addr.row = rrs.physicalRow(addr);
+        rrs.updateInfo(addr, 0);
+    };
+    // serves the swap traffic, returns the number of requests
+    auto serve = [&]() {
+        size_t served = 0;
+        auto traffic = rrs.takeCounterTraffic();
+        while (!traffic.empty()) {
+            for (const auto& trans : traffic) {
+                rrs.counterTrafficDone(trans);
+            }
+            served += traffic.size();
+            traffic = rrs.takeCounterTraffic();
+        }
+        return served;
+    };
+    const size_t row_requests = config.columns / config.BL;
+
+    SECTION("TEST swap traffic") {
+        activate(10);
+        REQUIRE(rrs.takeCounterTraffic().empty());
+        activate(10);
+        // both rows read out first
+        auto reads = rrs.takeCounterTraffic();
+        REQUIRE(reads.size() == 2 * row_requests);
+        for (const auto& trans : reads) {
+            REQUIRE(trans.is_swap);
+            REQUIRE(!trans.is_write);
+        }
+        for (size_t i = 0; i + 1 < reads.size(); i++) {
+            rrs.counterTrafficDone(reads[i]);
+        }
+        REQUIRE(rrs.takeCounterTraffic().empty());
+        rrs.counterTrafficDone(reads.back());
+        auto writes = rrs.takeCounterTraffic();
+        REQUIRE(writes.size() == 2 * row_requests);
+        for (const auto& trans : writes) {
+            REQUIRE(trans.is_swap);
+            REQUIRE(trans.is_write);
+            // not in place until the last write
+            REQUIRE(rrs.physicalRow(row(10)) == 10);
+            rrs.counterTrafficDone(trans);
+        }
+        REQUIRE(rrs.physicalRow(row(10)) != 10);
+        REQUIRE(rrs.takeCounterTraffic().empty());
+    }
+
+    SECTION("TEST bounded swap queue") {
+        for (int r : {10, 20, 30}) {
+            activate(r);
+            activate(r);
+        }
+        REQUIRE(rrs.physicalRow(row(10)) == 10);
+        // one swap after the other, the third one was dropped
+        REQUIRE(serve() == 2 * 4 * row_requests);
+        REQUIRE(rrs.physicalRow(row(10)) != 10);
+        REQUIRE(rrs.physicalRow(row(20)) != 20);
+        REQUIRE(rrs.physicalRow(row(30)) == 30);
+    }
+
+    SECTION("TEST the row table stays a permutation") {
+        size_t served = 0;
+        for (int i = 0; i < 2000; i++) {
+            activate(i % 7 * 3);
+            served += serve();
+        }
+        REQUIRE(served > 0);
+        std::vector<int> logical(config.rows, -1);
+        int moved = 0;
+        for (int r = 0; r < config.rows; r++) {
+            int physical = rrs.physicalRow(row(r));
+            if (physical >= 0 && physical < config.rows &&
+                logical[physical] < 0) {
+                logical[physical] = r;
+            }
+            moved += physical != r;
+        }
+        REQUIRE(std::count(logical.begin(), logical.end(), -1) == 0);
+        REQUIRE(moved > 0);
+        // another bank is not remapped
+        REQUIRE(rrs.physicalRow(dramsim3::Address(0, 0, 0, 1, 0, 0)) == 0);
+    }
+}
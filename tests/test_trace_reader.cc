@@ -0,0 +1,186 @@
+#include <cstdio>
+#include <fstream>
+#include <vector>
+#include "catch.hpp"
+#include "trace_reader.h"
+
+namespace {
+// a text trace of reads, writes and neighbor activations, with cycle
+// gaps beyond the binary deltas and addresses beyond 32 bits
+const std::string kTextTrace = "test_trace.txt";
+
+void WriteTextTrace(uint64_t num_trans) {
+    static const char* ops[] = {"READ", "WRITE", "NEI_ACT"};
+    std::ofstream trace(kTextTrace);
+    uint64_t cycle = 0;
+    for (uint64_t i = 0; i < num_trans; i++) {
+        uint64_t addr = (i * 0x9E3779B97F4A7C15ull) >> (i % 5 == 0 ? 8 : 34);
+        cycle += i % 1000 == 999 ? (1ull << 31) : i % 7;
+        trace << "0x" << std::hex << addr << std::dec << " " << ops[i % 3]
+              << " " << cycle << "\n";
+    }
+}
+
+std::vector<dramsim3::Transaction> ReadAll(dramsim3::TraceReader* reader) {
+    std::vector<dramsim3::Transaction> trace;
+    dramsim3::Transaction trans;
+    while (reader->Next(trans)) {
+        trace.push_back(trans);
+    }
+    delete reader;
+    return trace;
+}
+
+bool SameTransactions(const std::vector<dramsim3::Transaction>& a,
+                      const std::vector<dramsim3::Transaction>& b) {
+    if (a.size() != b.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < a.size(); i++) {
+        if (a[i].addr != b[i].addr || a[i].added_cycle != b[i].added_cycle ||
+            a[i].is_write != b[i].is_write ||
+            a[i].is_NEI_ACT != b[i].is_NEI_ACT) {
+            return false;
+        }
+    }
+    return true;
+}
+}  // namespace
+
+TEST_CASE("Binary trace round trip", "[trace]") {
+    const std::string trace_file = "test_trace.bin";
+    WriteTextTrace(10000);
+    auto text = ReadAll(dramsim3::GetTraceReader(kTextTrace));
+    REQUIRE(text.size() == 10000);
+    REQUIRE(dramsim3::ConvertTrace(kTextTrace, trace_file, "binary") ==
+            10000);
+    REQUIRE(dramsim3::GetTraceFormat(trace_file) == "binary");
+    REQUIRE(SameTransactions(ReadAll(dramsim3::GetTraceReader(trace_file)),
+                             text));
+    std::remove(kTextTrace.c_str());
+    std::remove(trace_file.c_str());
+}
+
+TEST_CASE("Compressed trace round trip", "[trace]") {
+    const std::string trace_file = "test_trace.ctr";
+    // more than one block
+    const uint64_t num_trans =
+        dramsim3::CompressedTraceReader::kBlockRecords * 2 + 10;
+    WriteTextTrace(num_trans);
+    auto text = ReadAll(dramsim3::GetTraceReader(kTextTrace));
+    REQUIRE(dramsim3::ConvertTrace(kTextTrace, trace_file, "compressed") ==
+            num_trans);
+    REQUIRE(dramsim3::GetTraceFormat(trace_file) == "compressed");
+    REQUIRE(SameTransactions(ReadAll(dramsim3::GetTraceReader(trace_file)),
+                             text));
+    // and back to text
+    const std::string text_file = "test_trace_back.txt";
+    dramsim3::ConvertTrace(trace_file, text_file, "text");
+    REQUIRE(SameTransactions(ReadAll(dramsim3::GetTraceReader(text_file)),
+                             text));
+    std::remove(kTextTrace.c_str());
+    std::remove(trace_file.c_str());
+    std::remove(text_file.c_str());
+}
+
+TEST_CASE("Prefetched trace", "[trace]") {
+    // more than the ring holds, so the producer waits for the consumer
+    const uint64_t num_trans =
+        dramsim3::PrefetchTraceReader::kRingSize * 3 + 10;
+    WriteTextTrace(num_trans);
+    auto text = ReadAll(dramsim3::GetTraceReader(kTextTrace));
+    REQUIRE(text.size() == num_trans);
+
+    SECTION("TEST same requests as the direct reader") {
+        REQUIRE(SameTransactions(
+            ReadAll(dramsim3::GetTraceReader(kTextTrace, true)), text));
+    }
+
+    SECTION("TEST stopped before the end of the trace") {
+        auto reader = dramsim3::GetTraceReader(kTextTrace, true);
+        dramsim3::Transaction trans;
+        for (int i = 0; i < 100; i++) {
+            REQUIRE(reader->Next(trans));
+            REQUIRE(trans.addr == text[i].addr);
+        }
+        // the producer is joined while still reading
+        delete reader;
+    }
+    std::remove(kTextTrace.c_str());
+}
+
+TEST_CASE("Compressed trace seek", "[trace]") {
+    const std::string trace_file = "test_seek.ctr";
+    const uint64_t block_records =
+        dramsim3::CompressedTraceReader::kBlockRecords;
+    const uint64_t num_trans = block_records + 100;
+    {
+        dramsim3::CompressedTraceWriter writer(trace_file);
+        for (uint64_t i = 0; i < num_trans; i++) {
+            dramsim3::Transaction trans(i * 64, i % 3 == 0);
+            trans.added_cycle = i * 2;
+            writer.Write(trans);
+        }
+    }
+    dramsim3::CompressedTraceReader reader(trace_file);
+    REQUIRE(reader.Index().size() == 2);
+    REQUIRE(reader.Index()[1].first_trans == block_records);
+
+    SECTION("TEST seek into the second block") {
+        uint64_t first = block_records + 10;
+        reader.SeekCycle(first * 2 - 1);
+        dramsim3::Transaction trans;
+        for (uint64_t i = first; i < num_trans; i++) {
+            REQUIRE(reader.Next(trans));
+            REQUIRE(trans.addr == i * 64);
+            REQUIRE(trans.added_cycle == i * 2);
+            REQUIRE(trans.is_write == (i % 3 == 0));
+        }
+        REQUIRE(!reader.Next(trans));
+    }
+
+    SECTION("TEST seek back to the first block") {
+        dramsim3::Transaction trans;
+        reader.SeekCycle(num_trans * 2);
+        REQUIRE(!reader.Next(trans));
+        reader.SeekCycle(0);
+        REQUIRE(reader.Next(trans));
+        REQUIRE(trans.addr == 0);
+        REQUIRE(trans.added_cycle == 0);
+    }
+    std::remove(trace_file.c_str());
+}
+
+TEST_CASE("Compressed trace seek at a block boundary", "[trace]") {
+    const std::string trace_file = "test_seek_boundary.ctr";
+    const uint64_t block_records =
+        dramsim3::CompressedTraceReader::kBlockRecords;
+    const uint64_t num_trans = block_records + 100;
+    // the requests around the end of the first block share one cycle
+    const uint64_t first = block_records - 10;
+    const uint64_t last = block_records + 10;
+    auto cycle = [&](uint64_t i) {
+        return i >= first && i <= last ? first : i;
+    };
+    {
+        dramsim3::CompressedTraceWriter writer(trace_file);
+        for (uint64_t i = 0; i < num_trans; i++) {
+            dramsim3::Transaction trans(i * 64, false);
+            trans.added_cycle = cycle(i);
+            writer.Write(trans);
+        }
+    }
+    dramsim3::CompressedTraceReader reader(trace_file);
+    REQUIRE(reader.Index().size() == 2);
+    REQUIRE(reader.Index()[1].first_cycle == first);
+
+    reader.SeekCycle(first);
+    dramsim3::Transaction trans;
+    for (uint64_t i = first; i < num_trans; i++) {
+        REQUIRE(reader.Next(trans));
+        REQUIRE(trans.addr == i * 64);
+        REQUIRE(trans.added_cycle == cycle(i));
+    }
+    REQUIRE(!reader.Next(trans));
+    std::remove(trace_file.c_str());
+}